@@ -1,36 +1,173 @@
 #pragma once
 #include <string>
-#include <set>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <deque>
+#include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include "protocol/message.h"
 #include "chat/user.h"
+#include "util/rate_limiter.h"
 
 namespace wagle {
 
+// 채팅 기록 항목 (브로드캐스트한 메시지 버퍼를 그대로 보관 - 다시 보낼 때 직렬화하지 않음)
+struct HistoryEntry {
+    uint64_t seq;        // 방 안의 메시지 순번 (1부터 증가)
+    User::Frame frame;
+};
+
+// 큰 방의 전송을 여러 스레드로 나눠 맡기는 실행기 목록
+// 각 실행기는 받은 작업을 순서대로 실행해야 함 (한 사용자는 항상 같은 실행기에서 전송되므로 순서 유지)
+struct FanoutPool {
+    using Executor = std::function<void(std::function<void()>)>;
+    
+    std::vector<Executor> executors;
+    size_t min_room_size = 0;  // 이 인원 이상인 방만 나눠서 전송 (0이면 사용 안 함)
+    
+    bool enabled() const { return min_room_size > 0 && executors.size() > 1; }
+};
+
 class ChatRoom {
 public:
-    // 사용자 입장
-    void join(std::shared_ptr<User> user);
+    using clock = std::chrono::steady_clock;
+    
+    // 사용자 수가 바뀔 때 방 이름으로 호출 (방 락을 잡지 않은 상태에서 호출됨)
+    using CountListener = std::function<void(const NameRef&)>;
+    
+    // 여러 방에 한 번에 보내는 메시지를 이미 받은 사용자 (이름 ID) - 대상 방들이 하나를 함께 씀
+    // 전달하는 순간 표시하므로 방 사이에 입장/퇴장이 있어도 한 사용자는 정확히 한 번 받음
+    class Recipients {
+    public:
+        // 처음 표시하면 true (이 사용자에게 보냄)
+        bool claim(NameId id) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return ids_.insert(id).second;
+        }
+        
+    private:
+        std::mutex mutex_;
+        std::unordered_set<NameId> ids_;
+    };
+    
+    // 알리지 않은 입장/퇴장 사용자 (이름 ID -> 알릴 때까지 유지하는 이름)
+    using PendingNames = std::unordered_map<NameId, NameRef>;
+    
+    // fanout이 있으면 큰 방의 전송을 그 실행기들에 나눠 맡김 (방보다 오래 살아야 함)
+    explicit ChatRoom(NameRef name, CountListener on_count_change = nullptr, const FanoutPool* fanout = nullptr)
+        : name_(std::move(name)), on_count_change_(std::move(on_count_change)), fanout_(fanout),
+          empty_since_(clock::now()) {}
+    
+    NameId getNameId() const { return name_.id(); }
+    const NameRef& getNameRef() const { return name_; }
+    const std::string& getName() const { return name_.name(); }
+    
+    // 사용자 입장 (이미 정리된 방이면 false)
+    // 최근 메시지 중 순번이 after_seq보다 큰 것만 다시 보냄 (재접속한 클라이언트는 놓친 구간만 받음)
+    bool join(std::shared_ptr<User> user, uint64_t after_seq = 0);
     
     // 사용자 퇴장
     void leave(std::shared_ptr<User> user);
     
-    // 모든 사용자에게 메시지 전송
-    void broadcast(const Message& msg);
-    
-    // 최근 메시지 가져오기
-    const std::deque<Message>& getRecentMessages() const { return recent_messages_; }
+    // 모든 사용자에게 메시지 전송 (recipients가 있으면 거기에 이미 표시된 사용자는 제외 - 기록과 순번은 그대로 남음)
+    // 보낸 사람은 이름으로 받음 (다른 노드의 사용자처럼 이 서버에 없는 이름도 등록하지 않음)
+    void broadcast(MessageType type, const std::string& sender, const std::string& content,
+                   std::shared_ptr<Recipients> recipients = nullptr);
     
     // 현재 사용자 수 가져오기
-    size_t getUserCount() const { return users_.size(); }
+    size_t getUserCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return users_.size();
+    }
+    
+    // 모아 둔 입장/퇴장 알림과 바뀐 사용자 수를 한 번에 전송 (입장/퇴장이 몰려도 주기마다 한 번)
+    void flushPending();
     
-    // 사용자 수 업데이트 메시지 전송
-    void broadcastUserCount();
+    // 방 전체 채팅 처리율 제한 확인 (한도 초과 시 false)
+    bool tryAcquireChat(const RateLimit& limit) { return chat_bucket_.tryConsume(limit); }
+    void releaseChat(const RateLimit& limit) { chat_bucket_.refund(limit); }
+    
+    // cutoff 이전부터 비어 있었으면 방을 닫음 (이후 입장 불가, 정리 대상)
+    bool closeIfIdle(clock::time_point cutoff);
+    
+    // cutoff 이전부터 비어 있었으면 최근 메시지를 비워 메모리 반환 (기본 방용)
+    bool compactIfIdle(clock::time_point cutoff, const std::string& log_dir);
+    
+    // 최근 메시지를 log_dir/<방 이름>.log 파일 끝에 기록
+    void saveHistory(const std::string& log_dir) const;
     
 private:
-    std::set<std::shared_ptr<User>> users_;
-    std::deque<Message> recent_messages_;
+    // 서버가 보내는 이 방의 알림 메시지
+    User::Frame serverFrame(MessageType type, const std::string& content) const;
+    
+    // 최근 메시지 저장 (mutex_를 잡은 상태에서 호출)
+    void remember(HistoryEntry entry);
+    void saveHistoryLocked(const std::string& log_dir) const;
+    
+    // 현재 사용자 수 메시지 (mutex_를 잡은 상태에서 호출)
+    User::Frame userCountFrame() const;
+    
+    // 아직 알리지 않은 입장/퇴장 요약과 사용자 수 메시지
+    struct PendingFrames {
+        User::Frame joined;
+        User::Frame left;
+        User::Frame count;
+        NameId lone_joiner = EMPTY_NAME_ID;  // 혼자 입장했으면 그 사용자 (본인에게는 알림 생략)
+        
+        void deliverTo(User& user) const;
+    };
+    
+    // 모아 둔 변경을 메시지로 만들고 비움 (mutex_를 잡은 상태에서 호출)
+    PendingFrames takePendingFrames();
+    
+    // 모든 사용자에게 알리지 않은 변경과 frame(없으면 생략, recipients에 이미 표시된 사용자도 생략)을 전송 (mutex_를 잡은 상태에서 호출)
+    // 큰 방은 사용자를 실행기 수만큼 나눠 각 실행기에서 전송
+    void fanOut(PendingFrames pending, const User::Frame& frame,
+                const std::shared_ptr<Recipients>& recipients = nullptr);
+    
+    // 나눠 전송할 때의 방 안 사용자 한 명 (입장할 때마다 새로 만들어 이전 입장의 전송과 구분)
+    struct Member {
+        explicit Member(std::shared_ptr<User> user) : user(std::move(user)) {}
+        
+        std::shared_ptr<User> user;
+        std::mutex mutex;       // 실행기의 전송과 퇴장이 겹치지 않게 함
+        bool present = true;    // 퇴장하면 false - 실행기에 남아 있던 이전 메시지는 더 보내지 않음 (mutex 보호)
+        size_t lane_slot = 0;   // 자기 실행기 목록 안의 위치 (그 실행기 스레드에서만 사용)
+    };
+    
+    // 실행기 하나가 맡는 사용자 목록 - 그 실행기 스레드에서만 읽고 고치며, 입장/퇴장은 전송과 같은 순서로 실행기에 넘김
+    using Lane = std::vector<std::shared_ptr<Member>>;
+    
+    // 방이 처음 나눠서 전송할 때 지금 사용자로 실행기별 목록을 만듦 (이후에는 입장/퇴장마다 한 명씩 고침)
+    void startLanes();
+    void addToLane(const std::shared_ptr<Member>& member);
+    void removeFromLane(const std::shared_ptr<Member>& member);
+    
+    NameRef name_;
+    CountListener on_count_change_;
+    const FanoutPool* fanout_;
+    
+    // 방마다 별도의 뮤텍스 - 서로 다른 방의 브로드캐스트가 서로를 막지 않음
+    mutable std::mutex mutex_;
+    // 사용자 -> 나눠 전송할 때의 입장 정보 (fanout을 쓰지 않는 방은 nullptr)
+    std::map<std::shared_ptr<User>, std::shared_ptr<Member>> users_;
+    std::unique_ptr<std::deque<HistoryEntry>> recent_messages_;  // 첫 메시지 저장 시 할당
+    uint64_t last_seq_ = 0;  // 마지막으로 매긴 메시지 순번
+    clock::time_point empty_since_;  // 마지막 사용자가 나간 시각
+    bool closed_ = false;
+    bool count_dirty_ = false;  // 알리지 않은 사용자 수 변경이 있음
+    PendingNames pending_joins_;   // 알리지 않은 입장 (입장/퇴장이 몰려도 상쇄 확인이 상수 시간)
+    PendingNames pending_leaves_;  // 알리지 않은 퇴장
+    
+    // 실행기별 사용자 목록 (한 번도 나눠서 전송하지 않은 방은 비어 있음)
+    std::vector<std::shared_ptr<Lane>> lanes_;
+    std::shared_ptr<std::atomic<size_t>> lanes_in_flight_;  // 실행기에서 아직 끝나지 않은 전송 수
+    TokenBucket chat_bucket_;
     static const size_t MAX_RECENT_MESSAGES = 100;
 };
 
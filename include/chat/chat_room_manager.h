@@ -1,8 +1,13 @@
 #pragma once
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include "chat/chat_room.h"
 
 namespace wagle {
@@ -16,17 +21,47 @@ struct ChatRoomInfo {
         : name(n), user_count(count), is_default(def) {}
 };
 
+// 같은 방을 쓰는 다른 서버 프로세스(노드)와 방 메시지를 주고받는 중계 연결
+// 관리자가 락을 잡은 채로 호출할 수 있으므로 구현은 바로 반환해야 함
+// 이름은 문자열로 넘김 (나중에 처리하는 동안 이름 ID가 해제되어 재사용될 수 있음)
+class RoomRelay {
+public:
+    virtual ~RoomRelay() = default;
+    
+    // 이 노드에서 만든 방을 다른 노드에 알림
+    virtual void announceRoom(const std::string& room_name) = 0;
+    
+    // 이 노드에서 방을 정리함 - 모든 노드가 정리하면 중계 서버의 목록에서도 빠짐
+    virtual void withdrawRoom(const std::string& room_name) = 0;
+    
+    // 방에 이 노드의 사용자가 생기거나(local=true) 모두 나감 - 사용자가 있는 방의 메시지만 받음
+    virtual void setRoomInterest(const std::string& room_name, bool local) = 0;
+    
+    // 이 노드의 사용자가 보낸 채팅을 다른 노드에 전달
+    virtual void publish(const std::string& room_name, const std::string& sender, const std::string& content) = 0;
+};
+
 class ChatRoomManager {
 public:
+    // 방 작업을 그 방을 맡은 스레드에서 실행하게 넘기는 실행기
+    using RoomExecutor = std::function<void(NameId room_id, std::function<void()> task)>;
+    
     ChatRoomManager();
     
-    // 채팅방 생성
+    // 채팅방 생성 (중계 연결이 있으면 다른 노드에도 알림)
     bool createRoom(const std::string& room_name);
     
+    // 다른 노드가 알려 온 채팅방 추가 (다시 알리지 않음)
+    bool addRemoteRoom(const std::string& room_name);
+    
+    // 방 이름으로 쓸 수 있는지 (',' ';'는 여러 방 지정과 목록 항목 구분에 쓰이므로 불가)
+    static bool isValidRoomName(const std::string& room_name);
+    
     // 채팅방 가져오기
     std::shared_ptr<ChatRoom> getRoom(const std::string& room_name);
+    std::shared_ptr<ChatRoom> getRoom(NameId room_id);
     
-    // 채팅방 목록 가져오기
+    // 채팅방 목록 가져오기 (이름순)
     std::vector<ChatRoomInfo> getRoomList() const;
     
     // 채팅방 삭제 (기본 방은 삭제 불가)
@@ -35,10 +70,91 @@ public:
     // 채팅방 존재 여부 확인
     bool roomExists(const std::string& room_name) const;
     
+    // 전체 채팅방 수
+    size_t getRoomCount() const { return room_count_.load(std::memory_order_relaxed); }
+    
+    // 채팅방 목록을 "이름,사용자 수,기본 방 여부;..." 형식으로 변환
+    std::string encodeRoomList() const;
+    
+    // 채팅방 목록 변경 구독 - 현재 목록(ROOM_LIST, room_name에 버전)을 바로 보내고
+    // 이후 변경분은 publishRoomUpdates()가 모아서 ROOM_LIST_DELTA로 보냄
+    void subscribeRoomList(const std::shared_ptr<User>& user);
+    void unsubscribeRoomList(const User* user);
+    
+    // 마지막 발행 이후 쌓인 변경분을 한 번에 전송 (사용자 수 변경은 방마다 하나로 합쳐짐)
+    // 목록 구독자에게는 ROOM_LIST_DELTA, 사용자가 바뀐 방의 사용자에게는 입장/퇴장 요약과 USER_COUNT
+    void publishRoomUpdates();
+    
+    // 모든 방의 최근 메시지를 log_dir에 기록 (서버 종료 시)
+    void saveAllHistory(const std::string& log_dir) const;
+    
+    // 다른 노드와 방을 공유할 중계 연결 설정 (연결을 받기 전에 설정하고, 중계 연결보다 먼저 해제)
+    void setRelay(RoomRelay* relay);
+    
+    // 이 노드의 사용자가 있는 방인지 (아니면 다른 노드에만 사용자가 있거나 빈 방)
+    bool isLocalRoom(NameId room_id) const;
+    
+    // 이 노드의 사용자가 있는 방 이름 목록 (중계 연결을 다시 맺을 때 구독을 복구)
+    std::vector<std::string> getLocalRooms() const;
+    
+    // 이 노드의 사용자가 보낸 채팅을 다른 노드에 전달 (중계 연결이 없으면 무시)
+    void relayChat(const ChatRoom& room, const std::string& sender, const std::string& content);
+    
+    // 다른 노드에서 온 채팅을 이 노드의 사용자들에게 전송 (사용자가 없는 방이면 버림)
+    void deliverRemote(const std::string& room_name, const std::string& sender, const std::string& content);
+    
+    // 큰 방의 전송을 나눠 맡길 실행기 설정 (연결을 받기 전에 한 번 호출)
+    void setFanoutPool(FanoutPool pool) { fanout_ = std::move(pool); }
+    
+    // 발행 시 방 안의 사용자들에게 보내는 알림을 방을 맡은 스레드로 넘김 (비어 있으면 호출한 스레드에서 전송)
+    void setRoomExecutor(RoomExecutor executor) { room_executor_ = std::move(executor); }
+    
+    // idle 이상 비어 있던 방 정리 (기본 방은 최근 메시지만 비움)
+    // log_dir이 비어 있지 않으면 정리 전 최근 메시지를 파일로 기록. 정리한 방 수 반환
+    size_t reapIdleRooms(std::chrono::seconds idle, const std::string& log_dir);
+    
 private:
-    mutable std::mutex rooms_mutex_;
-    std::map<std::string, std::shared_ptr<ChatRoom>> rooms_;
+    // 이름 ID로 나눈 샤드 - 서로 다른 샤드의 방은 동시에 조회/생성 가능
+    static const size_t SHARD_COUNT = 16;
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<NameId, std::shared_ptr<ChatRoom>> rooms;
+    };
+    
+    Shard& shardFor(NameId room_id) { return shards_[room_id % SHARD_COUNT]; }
+    const Shard& shardFor(NameId room_id) const { return shards_[room_id % SHARD_COUNT]; }
+    
+    bool addRoom(const std::string& room_name, bool announce);
+    
+    // 방의 사용자 수가 바뀌면 이 노드의 사용자가 있는지 다시 확인해 중계 연결의 구독을 맞춤
+    void updateInterest(const NameRef& room_name);
+    
+    // 발행 대기 중인 목록 변경 (발행할 때까지 방 이름을 유지 - 정리된 방의 ID가 그 사이 재사용되지 않게)
+    enum class RoomChange { ADDED, REMOVED, COUNT };
+    struct PendingChange {
+        RoomChange change;
+        NameRef room_name;
+    };
+    void noteRoomChange(const NameRef& room_name, RoomChange change);
+    
+    FanoutPool fanout_;  // 방보다 먼저 선언 (방이 참조)
+    RoomExecutor room_executor_;
+    
+    // 클러스터 상태 - 락 순서는 interest_mutex_ -> 샤드 -> 방
+    RoomRelay* relay_ = nullptr;
+    mutable std::mutex interest_mutex_;
+    std::unordered_map<NameId, NameRef> local_rooms_;  // 이 노드의 사용자가 있는 방
+    Shard shards_[SHARD_COUNT];
+    std::atomic<size_t> room_count_{0};
+    NameRef default_room_;
+    
+    // 목록 구독 상태 - 락 순서는 feed_mutex_ -> 샤드 -> 방
+    std::mutex feed_mutex_;
+    uint64_t feed_version_ = 0;
+    std::unordered_map<NameId, PendingChange> pending_changes_;
+    std::unordered_map<NameId, std::shared_ptr<User>> subscribers_;
     static const std::string DEFAULT_ROOM_NAME;
 };
 
-} // namespace wagle
\ No newline at end of file
+} // namespace wagle
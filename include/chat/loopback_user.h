@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "chat/user.h"
+
+namespace wagle {
+
+// 소켓 없이 프로세스 안에서 채팅방에 참여하는 사용자
+// 봇이나 사이드카가 메시지를 직접 받거나, 커널을 거치지 않고 팬아웃 비용만 측정할 때 사용
+class LoopbackUser : public User {
+public:
+    // 메시지를 받을 때마다 호출 (deliver를 호출한 스레드에서, 방 락을 잡은 채로 실행되므로 짧게 처리)
+    using Handler = std::function<void(const Frame&)>;
+    
+    explicit LoopbackUser(NameRef name, Handler on_frame = nullptr);
+    
+    void deliver(const Frame& frame) override;
+    
+    // 지금까지 받은 메시지 수와 바이트 수
+    uint64_t getFrameCount() const { return frames_.load(std::memory_order_relaxed); }
+    uint64_t getByteCount() const { return bytes_.load(std::memory_order_relaxed); }
+    
+private:
+    Handler on_frame_;
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+};
+
+} // namespace wagle
@@ -1,34 +1,38 @@
 #pragma once
-#include <boost/asio.hpp>
 #include <memory>
 #include <string>
+#include "util/name_table.h"
 
 namespace wagle {
 
+// 채팅방이 메시지를 보내는 대상 - 전송 방식(TCP, Unix 도메인 소켓, 프로세스 내부)은 구현마다 다름
 class User : public std::enable_shared_from_this<User> {
    public:
-    using tcp = boost::asio::ip::tcp;
+    // 직렬화된 메시지 (여러 수신자가 같은 버퍼를 공유)
+    using Frame = std::shared_ptr<const std::string>;
 
-    User(tcp::socket& socket, const std::string& name)
-        : socket_(socket), name_(name) {}
+    explicit User(NameRef name) : name_(std::move(name)) {}
 
     virtual ~User() = default;
 
-    std::string getName() const { return name_; }
-    virtual tcp::socket& getSocket() { return socket_; }
+    const std::string& getName() const { return name_.name(); }
+    NameId getNameId() const { return name_.id(); }
+    const NameRef& getNameRef() const { return name_; }
     
-    // 사용자 비교를 위한 연산자 (이름 기반)
+    // 사용자의 송신 큐에 메시지 추가 (어느 스레드에서나 호출 가능, 블로킹 없음)
+    virtual void deliver(const Frame& frame) = 0;
+    
+    // 사용자 비교를 위한 연산자 (이름 ID 기반)
     bool operator==(const User& other) const {
-        return name_ == other.name_;
+        return getNameId() == other.getNameId();
     }
     
     bool operator<(const User& other) const {
-        return name_ < other.name_;
+        return getNameId() < other.getNameId();
     }
 
    private:
-    tcp::socket& socket_;
-    std::string name_;
+    NameRef name_;  // 사용자가 있는 동안 이름 ID를 유지
 };
 
-}  // namespace wagle
\ No newline at end of file
+}  // namespace wagle
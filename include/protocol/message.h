@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -16,9 +17,18 @@ enum class MessageType {
     ROOM_CREATE,    // 채팅방 생성 요청
     ROOM_JOIN,      // 채팅방 입장 요청
     ROOM_LEAVE,     // 채팅방 퇴장 요청
-    ROOM_ERROR      // 채팅방 관련 오류
+    ROOM_ERROR,     // 채팅방 관련 오류
+    PING,           // 연결 확인 요청
+    PONG,           // 연결 확인 응답
+    DIRECT_MSG,     // 개인 메시지 (room_name 필드에 받는 사람 이름)
+    ROOM_SUBSCRIBE, // 채팅방 목록 변경 구독 (내용 "1"이면 구독, "0"이면 해제)
+    ROOM_LIST_DELTA, // 채팅방 목록 변경분 (room_name 필드에 목록 버전)
+    ROOM_JOIN_KEEP   // 이전 방에서 나가지 않고 채팅방 추가 입장 (응답은 ROOM_JOIN)
 };
 
+// 마지막 메시지 타입 (수신한 타입 값 검증용, 타입 추가 시 함께 갱신)
+constexpr MessageType LAST_MESSAGE_TYPE = MessageType::ROOM_JOIN_KEEP;
+
 // 메시지 클래스
 class Message {
    public:
@@ -43,17 +53,24 @@ class Message {
     std::string unescapeSpecialChars(const std::string& str) const;
 
     MessageType getType() const { return type_; }
-    std::string getSender() const { return sender_; }
-    std::string getContent() const { return content_; }
-    std::string getRoomName() const { return room_name_; }
+    // 필드는 복사하지 않고 참조로 돌려줌 (메시지 객체보다 오래 쓰려면 복사해서 보관)
+    const std::string& getSender() const { return sender_; }
+    const std::string& getContent() const { return content_; }
+    const std::string& getRoomName() const { return room_name_; }
     
     void setRoomName(const std::string& room_name) { room_name_ = room_name; }
+    
+    // 채팅방 안의 메시지 순번 (0이면 없음, 직렬화 시 마지막 필드로 붙음)
+    // 서버가 보내는 CHAT_MSG에 붙고, 클라이언트는 ROOM_JOIN에 마지막으로 받은 순번을 실어 이후 메시지만 받음
+    uint64_t getSeq() const { return seq_; }
+    void setSeq(uint64_t seq) { seq_ = seq; }
 
    private:
     MessageType type_ = MessageType::CHAT_MSG;
     std::string sender_;
     std::string content_;
     std::string room_name_;  // 채팅방 이름 추가
+    uint64_t seq_ = 0;
 };
 
 }  // namespace wagle
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "util/handler_allocator.h"
+#include "util/mpsc_queue.h"
+#include "util/name_table.h"
+#include "util/timer_wheel.h"
+
+namespace wagle {
+
+// 코어별 샤드 - 샤드마다 io_context와 스레드, 타이밍 휠, 받은 작업 큐를 하나씩 둠
+// 채팅방은 이름 ID로 한 샤드가 맡고, 세션은 방에 입장할 때 그 방을 맡은 샤드로 옮겨 가므로
+// 정상 상태에서는 방과 그 방 사용자들의 작업이 모두 한 스레드에서 처리된다.
+// 다른 샤드에 맡길 작업은 크기가 고정된 락 없는 큐를 거쳐 전달됨
+class CoreShards {
+public:
+    using Task = std::function<void()>;
+
+    CoreShards(std::size_t count, std::chrono::milliseconds wheel_tick);
+    ~CoreShards();
+    CoreShards(const CoreShards&) = delete;
+    CoreShards& operator=(const CoreShards&) = delete;
+
+    std::size_t size() const { return shards_.size(); }
+
+    // 방을 맡은 샤드
+    std::size_t ownerOf(NameId room_id) const { return room_id % shards_.size(); }
+
+    // 지금 스레드가 실행 중인 샤드 (샤드 스레드가 아니면 -1)
+    static int currentIndex();
+
+    boost::asio::io_context& context(std::size_t index) { return shards_[index]->context; }
+    const std::shared_ptr<TimerWheel>& timerWheel(std::size_t index) const { return shards_[index]->timer_wheel; }
+
+    // 샤드의 받은 작업 큐에 넣음 (어느 스레드에서나 호출 가능)
+    // 큐가 가득 차 있으면 false이며 task는 그대로 남음
+    bool post(std::size_t index, Task&& task);
+
+    // 모든 샤드 스레드를 멈추고 기다림 (여러 번 호출해도 됨)
+    void stop();
+
+private:
+    struct Shard {
+        Shard(std::size_t index, std::chrono::milliseconds wheel_tick);
+
+        std::size_t index;
+        boost::asio::io_context context{1};
+        BoundedMpscQueue<Task> inbox;
+        std::atomic<bool> drain_scheduled{false};  // 큐를 비우는 작업이 이미 예약됨
+        HandlerMemory drain_memory;                 // 큐를 비우는 작업용 (예약은 한 번에 하나뿐이므로 깨울 때 할당하지 않음)
+        std::shared_ptr<TimerWheel> timer_wheel;
+        boost::asio::steady_timer wheel_timer;
+        std::thread thread;
+    };
+
+    void drainInbox(Shard& shard);
+    void scheduleDrain(Shard& shard);
+    void scheduleWheelTick(Shard& shard);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// 소켓을 다른 io_context로 옮김 (대기 중인 비동기 작업이 없을 때 원래 소켓의 스레드에서 호출)
+// 이동 대입은 원래 io_context의 리액터 등록을 그대로 가져가므로, 디스크립터를 떼어 내 새로 등록함
+// 소켓이 이미 닫혀 있으면 닫힌 소켓을 돌려줌
+boost::asio::generic::stream_protocol::socket moveSocket(boost::asio::generic::stream_protocol::socket& socket,
+                                                        boost::asio::io_context& target);
+
+} // namespace wagle
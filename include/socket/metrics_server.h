@@ -0,0 +1,21 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <memory>
+
+namespace wagle {
+
+// 지표 수집용 HTTP 엔드포인트 (GET /metrics)
+// 채팅 포트와 별도의 포트에서 동작하며 요청마다 Prometheus 텍스트 형식으로 응답한다.
+class MetricsServer {
+public:
+    using tcp = boost::asio::ip::tcp;
+
+    MetricsServer(boost::asio::io_context& io_context, const tcp::endpoint& endpoint);
+
+private:
+    void startAccept();
+
+    tcp::acceptor acceptor_;
+};
+
+} // namespace wagle
@@ -0,0 +1,65 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include "chat/chat_room_manager.h"
+#include "protocol/message.h"
+
+namespace wagle {
+
+// 중계 서버(wagle_relay)와의 연결 - 같은 방을 쓰는 다른 서버 프로세스와 방 메시지를 주고받음
+// 채팅과 같은 메시지 형식을 쓰며, 연결하면 CONNECT(노드 이름), 이 노드의 방(ROOM_CREATE),
+// 사용자가 있는 방의 구독(ROOM_JOIN)을 보낸다. 중계 서버는 구독한 방의 CHAT_MSG만 보내 줌
+// 오래 비어 있던 방을 정리하면 ROOM_LIST_DELTA("-방 이름")로 알리며, 다른 노드에 사용자가 있으면 방을 다시 받음
+// 모든 작업은 io_context 스레드에서 처리되며, RoomRelay 메서드는 어느 스레드에서나 호출 가능
+class RelayLink : public RoomRelay {
+public:
+    using tcp = boost::asio::ip::tcp;
+
+    RelayLink(boost::asio::io_context& io_context, ChatRoomManager& room_manager, std::string host,
+              std::string port, std::string node_name);
+
+    // 연결 시작 (끊기면 간격을 늘려 가며 다시 연결)
+    void start();
+
+    // 연결을 닫고 다시 연결하지 않음 (io_context 스레드에서 호출)
+    void stop();
+
+    void announceRoom(const std::string& room_name) override;
+    void withdrawRoom(const std::string& room_name) override;
+    void setRoomInterest(const std::string& room_name, bool local) override;
+    void publish(const std::string& room_name, const std::string& sender, const std::string& content) override;
+
+private:
+    void connect();
+    void scheduleReconnect();
+    void onConnected();
+    void readFrame();
+    void handleFrame(const std::string& data);
+    void send(const Message& msg);  // 연결되어 있을 때만 큐에 넣음
+    void writeQueued();
+
+    boost::asio::io_context& io_context_;
+    ChatRoomManager& room_manager_;
+    std::string host_;
+    std::string port_;
+    std::string node_name_;
+
+    tcp::socket socket_;
+    tcp::resolver resolver_;
+    boost::asio::steady_timer reconnect_timer_;
+    boost::asio::streambuf buffer_;
+    bool connected_ = false;
+    unsigned generation_ = 0;  // 연결마다 증가 - 이전 연결의 늦은 완료 핸들러를 무시
+    bool stopped_ = false;
+    int reconnect_attempts_ = 0;
+    std::mt19937 jitter_{std::random_device{}()};
+
+    std::deque<std::string> write_queue_;
+    bool writing_ = false;
+};
+
+} // namespace wagle
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include "util/rate_limiter.h"
+
+namespace wagle {
+
+// 요청 종류별 처리율 제한
+struct RateLimitConfig {
+    RateLimit session_chat{10, 20};   // 연결당 채팅 메시지
+    RateLimit room_chat{200, 400};    // 채팅방당 채팅 메시지 (전체 사용자 합산)
+    RateLimit room_create{1, 3};      // 연결당 채팅방 생성
+    RateLimit room_list{5, 10};       // 연결당 채팅방 목록 요청 (모든 방 순회)
+};
+
+// 서버 설정
+struct ServerConfig {
+    RateLimitConfig rate_limits;
+    std::string limits_file;  // 처리율 제한 파일 (SIGHUP을 받으면 다시 읽음, 비어 있으면 사용 안 함)
+    
+    // 수신 크기 제한
+    std::size_t max_line_bytes = 4096;    // 한 메시지(줄)의 최대 길이
+    std::size_t max_frame_bytes = 16384;  // 연결당 수신 버퍼 최대 크기 (max_line_bytes 이상)
+    
+    // 연결 하나가 동시에 입장할 수 있는 방 수
+    std::size_t max_rooms_per_session = 16;
+    
+    // 연결당 송신 대기 메시지 수 제한 (넘으면 느린 연결로 보고 끊음)
+    std::size_t max_outbound_frames = 1024;
+    
+    // 연결 유지 확인
+    std::chrono::seconds heartbeat_interval{15};  // 이 시간 동안 수신이 없으면 PING, 다시 이만큼 응답이 없으면 종료
+    std::chrono::seconds login_timeout{30};       // 접속부터 사용자 이름 확정까지의 기한
+    
+    // 빈 채팅방 정리
+    std::chrono::seconds room_idle_timeout{300};  // 이 시간 이상 비어 있던 방을 정리 (0이면 사용 안 함)
+    std::string room_log_dir;                     // 정리 전 최근 메시지를 기록할 디렉터리 (비어 있으면 기록 안 함)
+    
+    // 연결 수락
+    std::size_t acceptor_threads = 1;  // 수락 루프(스레드) 수, 2 이상이면 SO_REUSEPORT로 같은 포트를 나눠 받음
+    int listen_backlog = 1024;         // 수락 대기열 길이 (커널의 somaxconn을 넘을 수 없음)
+    std::string unix_socket_path;      // 로컬 봇/사이드카용 Unix 도메인 소켓 경로 (비어 있으면 사용 안 함)
+    
+    // 이 인원 이상인 방의 메시지는 수락 스레드들에 나눠서 전송 (0이면 사용 안 함, 수락 스레드가 2개 이상일 때만)
+    std::size_t fanout_min_room = 5000;
+    
+    // 코어별 샤드 수 - 방마다 맡은 샤드 스레드가 있고 세션은 입장한 방의 샤드로 옮겨 감 (0이면 사용 안 함)
+    std::size_t core_shards = 0;
+    
+    // 클러스터 - 중계 서버를 거쳐 다른 서버 프로세스와 같은 방을 공유
+    std::string relay_address;  // 중계 서버 "호스트:포트" (비어 있으면 사용 안 함)
+    std::string node_name;      // 중계 서버에 알릴 이 서버의 이름 (비어 있으면 호스트 이름:포트)
+    
+    // 연결이 끊긴 뒤 재개 토큰으로 같은 이름을 다시 쓸 수 있는 시간 (0이면 재개 사용 안 함)
+    std::chrono::seconds resume_window{60};
+    
+    // 종료 시 송신 큐를 비우며 연결이 닫히기를 기다리는 최대 시간
+    std::chrono::seconds shutdown_timeout{5};
+    
+    // 지표 HTTP 엔드포인트 포트 (0이면 사용 안 함)
+    unsigned short metrics_port = 0;
+};
+
+} // namespace wagle
@@ -1,13 +1,30 @@
 #pragma once
 #include <boost/asio.hpp>
+#ifdef WAGLE_USE_COROUTINES
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
 #include <memory>
 #include <iostream>
 #include <ncurses.h>
 #include <ctime>
 #include <cstdarg>
-#include <set>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
 #include "chat/chat_room_manager.h" // ChatRoomInfo 정의 포함
+#include "socket/core_shards.h"
+#include "socket/relay_link.h"
+#include "socket/server_config.h"
+#include "socket/user_registry.h"
+#include "util/timer_wheel.h"
+#include "util/handler_allocator.h"
 
 // Forward declarations
 namespace wagle {
@@ -23,8 +40,7 @@ namespace wagle {
 extern WINDOW* main_win;
 extern WINDOW* status_win;
 extern WINDOW* log_win;
-extern int total_connections;
-extern std::set<std::string> active_usernames;
+extern std::atomic<int> total_connections;
 
 // 함수 선언
 void init_server_ui();
@@ -32,43 +48,131 @@ void cleanup_server_ui();
 void update_status_window(size_t user_count, const std::vector<wagle::ChatRoomInfo>& room_list);
 void add_log_message(const char* format, ...);
 
-// Session용 User 클래스
-class SessionUser : public std::enable_shared_from_this<SessionUser> {
-public:
-    using tcp = boost::asio::ip::tcp;
+class Session;
 
-    SessionUser(tcp::socket& socket, const std::string& name);
-    std::string getName() const;
-    tcp::socket& getSocket();
+// Session용 User 클래스 - 채팅방의 메시지를 세션의 송신 큐로 전달
+class SessionUser : public User {
+public:
+    SessionUser(std::weak_ptr<Session> session, NameRef name);
+    void deliver(const Frame& frame) override;
 
 private:
-    tcp::socket& socket_;
-    std::string name_;
+    std::weak_ptr<Session> session_;
 };
 
 // 세션 클래스
 class Session : public std::enable_shared_from_this<Session> {
 public:
-    using tcp = boost::asio::ip::tcp;
+    // TCP와 Unix 도메인 소켓을 같은 세션 코드로 처리
+    using Socket = boost::asio::generic::stream_protocol::socket;
     
-    Session(tcp::socket socket, ChatRoomManager& room_manager);
+    // core_shards가 있으면 세션은 shard 번째 샤드의 io_context에서 시작하고, 방에 입장할 때 그 방의 샤드로 옮겨 감
+    Session(Socket socket, std::string client_address, ChatRoomManager& room_manager,
+            UserRegistry& user_registry, const ServerConfig& config, std::shared_ptr<TimerWheel> timer_wheel,
+            CoreShards* core_shards = nullptr, int shard = -1);
+    ~Session();
     void start();
     
+    // 송신 큐에 메시지 추가 (어느 스레드에서나 호출 가능)
+    void deliver(const User::Frame& frame);
+    
+    // DISCONNECT를 보내고 송신 큐를 다 비우면 연결을 닫음 (어느 스레드에서나 호출 가능)
+    void disconnect(const std::string& reason);
+    
+    // 서버 종료 알림
+    void drain() { disconnect("Server is shutting down"); }
+    
 private:
+#ifdef WAGLE_USE_COROUTINES
+    // 연결이 끊길 때까지 읽고 처리하는 코루틴 (self는 코루틴 프레임에 보관되어 세션을 유지)
+    // 실험용 - 콜백 루프보다 할당이나 CPU 사용이 줄지 않아 기본 빌드는 콜백 루프를 씀
+    boost::asio::awaitable<void> run(std::shared_ptr<Session> self);
+#else
     void readUsername();
     void readMessage();
+#endif
+    void resumeReading();                   // 샤드를 옮긴 뒤 새 io_context에서 읽기 재개
+    // 소켓이 속한 io_context의 실행기 - any_io_executor로 post하면 작업을 감싸느라 매번 힙을 쓰므로
+    // 핸들러 메모리를 붙인 post는 이 실행기로 보냄 (write_mutex_를 잡았거나 세션 스레드에서 호출)
+    boost::asio::io_context::executor_type sessionExecutor();
+    void postToSession(std::function<void()> task);  // 세션이 지금 있는 스레드에서 실행
+    bool handleLogin(const Message& msg);  // 사용자 이름 확정 (실패 시 false)
+    void dispatch(const Message& msg);      // 로그인 후 받은 요청 처리
+    void onDisconnected();                  // 로그인한 연결이 끊겼을 때 정리
     void handleRoomListRequest();
+    void handleRoomSubscribe(const std::string& content);
     void handleRoomCreateRequest(const std::string& room_name);
-    void handleRoomJoinRequest(const std::string& room_name);
-    void handleRoomLeaveRequest();
+    void handleRoomJoinRequest(const std::string& room_name, uint64_t after_seq, bool keep_rooms);
+    void joinRoom(const std::shared_ptr<ChatRoom>& room, const std::string& room_name, uint64_t after_seq);
+    void handleRoomLeaveRequest(const std::string& room_name);
+    void handleChatMessage(const Message& msg);
+    void broadcastTo(const std::vector<std::shared_ptr<ChatRoom>>& targets, const std::string& content);
+    std::shared_ptr<ChatRoom> findJoinedRoom(const std::string& room_name) const;
+    void leaveRoom(const std::shared_ptr<ChatRoom>& room);
+    void leaveAllRooms();
+    void handleDirectMessage(const Message& msg);
+    bool extractFrame(std::size_t length, std::string& data);
+    bool parseFrame(const std::string& data, Message& msg);
+    void send(const Message& msg);
+    void writeQueued();
+    void discardOversizedFrame();
+    void touchLiveness();
+    void onLivenessTimeout();
+    void sendRateLimitError();
+    
+    // 샤드 이동 - 읽기를 멈추고 진행 중인 쓰기가 끝나면 소켓을 옮긴 뒤 새 스레드에서 이어서 처리
+    void beginMigration();
+    void completeMigration();  // 옛 스레드에서 소켓과 타이머를 넘김
+    void finishMigration();    // 새 스레드에서 멈춰 둔 쓰기/읽기 재개
     
-    tcp::socket socket_;
+    Socket socket_;
     ChatRoomManager& room_manager_;
-    boost::asio::streambuf buffer_;
-    std::string username_;
+    UserRegistry& user_registry_;
+    const ServerConfig& config_;
+    boost::asio::streambuf buffer_;  // max_frame_bytes로 크기 제한
+    std::string line_;               // 받은 한 줄 (용량을 재사용해 메시지마다 할당하지 않음)
+    bool discarding_ = false;        // 크기 초과 프레임을 줄 끝까지 버리는 중
+    // 로그와 전송에 쓸 사용자 이름 (세션이 있는 동안 이름 ID를 유지)
+    const std::string& username() const { return user_name_.name(); }
+    
+    NameRef user_name_;
     std::string client_address_;
-    std::string current_room_;
+    std::vector<std::shared_ptr<ChatRoom>> rooms_;  // 입장한 방 (입장 순서, 마지막 방이 방 이름 없는 채팅의 대상)
     std::shared_ptr<SessionUser> user_;
+    bool logged_in_ = false;
+    
+    // 연결 유지 확인 타이머 (세션마다 타이머를 두지 않고 공용 타이밍 휠에 등록)
+    std::shared_ptr<TimerWheel> timer_wheel_;
+    TimerWheel::Entry liveness_timer_;
+    bool ping_outstanding_ = false;
+    
+    // 송신 큐 - 쓰기는 한 번에 하나만 진행하며, 대기 중인 메시지는 모아서 한 번에 전송
+    std::mutex write_mutex_;
+    std::vector<User::Frame> write_queue_;
+    std::vector<User::Frame> writing_;  // 전송 중인 메시지 (완료될 때까지 버퍼 유지, 다음 전송 때 write_queue_와 맞바꿈)
+    std::vector<boost::asio::const_buffer> write_buffers_;  // writing_의 버퍼 목록 (용량 재사용)
+    bool write_in_progress_ = false;
+    bool write_stopped_ = false;        // 큐 넘침 또는 쓰기 오류로 더 이상 보내지 않음
+    bool close_after_flush_ = false;    // 종료 중 - 새 메시지는 받지 않고 큐를 비우면 송신 쪽을 닫음
+    bool draining_ = false;             // 종료 중 - 수신한 요청은 처리하지 않음 (세션 스레드 전용)
+    bool migrating_ = false;            // 샤드 이동 중 - 새 쓰기를 시작하지 않고 큐에 모아 둠
+    
+    // 코어 샤드 (사용하지 않으면 nullptr)
+    CoreShards* core_shards_;
+    int shard_;                          // 세션이 있는 샤드 (write_mutex_ 보호, 세션 스레드에서는 그냥 읽음)
+    int migrate_to_ = -1;                // 지금 요청을 처리한 뒤 옮겨 갈 샤드 (세션 스레드 전용)
+    std::function<void()> after_migration_;  // 옮긴 뒤 새 스레드에서 이어서 할 일
+    
+    // 읽기/쓰기 완료 핸들러용 재사용 메모리 (각각 한 번에 하나만 진행됨)
+    // 핸들러가 세션을 붙잡고 있어 io_context가 남은 작업을 정리할 때까지 메모리가 유지됨
+    HandlerMemory read_memory_;
+    HandlerMemory write_memory_;
+    HandlerMemory task_memory_;  // 다른 스레드에서 넘긴 작업 (겹치면 힙 사용)
+    
+    // 요청 종류별 처리율 제한 버킷
+    TokenBucket chat_bucket_;
+    TokenBucket room_create_bucket_;
+    TokenBucket room_list_bucket_;
 };
 
 // 소켓 매니저 클래스
@@ -76,14 +180,58 @@ class SocketManager {
 public:
     using tcp = boost::asio::ip::tcp;
     
-    SocketManager(boost::asio::io_context& io_context, const tcp::endpoint& endpoint);
+    // config.acceptor_threads가 1보다 크면 SO_REUSEPORT로 같은 포트에 수락 소켓을 여러 개 열고
+    // 첫 번째는 io_context에서, 나머지는 각자의 io_context와 스레드에서 실행
+    SocketManager(boost::asio::io_context& io_context, const tcp::endpoint& endpoint,
+                  ServerConfig& config);
     ~SocketManager();
     
+    // 연결 수락을 멈추고 접속 중인 세션에 종료를 알린 뒤 모든 연결이 닫히거나
+    // shutdown_timeout이 지나면 on_drained 호출 (io_context 스레드에서 호출)
+    void shutdown(std::function<void()> on_drained);
+    
 private:
-    void startAccept();
+    // 수락 루프 하나 - 자기 io_context의 세션만 관리하는 타이밍 휠을 가짐
+    struct Listener {
+        Listener(boost::asio::io_context& io_context, const tcp::endpoint& endpoint,
+                 const ServerConfig& config, bool reuse_port);
+        
+        tcp::acceptor acceptor;
+        std::shared_ptr<TimerWheel> timer_wheel;
+        boost::asio::steady_timer wheel_timer;
+    };
     
-    tcp::acceptor acceptor_;
+    void startAccept(Listener& listener);
+    void startSession(Session::Socket socket, std::string address, Listener& listener);
+    void startUnixAccept();
+    void scheduleWheelTick(Listener& listener);
+    void scheduleRoomReap();  // 오래 비어 있는 방 주기적 정리
+    void scheduleRoomUpdatePublish();  // 채팅방 목록/사용자 수 변경 주기적 발행
+    void waitForDrain();
+    
+    ServerConfig& config_;
+    boost::asio::steady_timer reap_timer_;
+    boost::asio::steady_timer room_update_timer_;
+    boost::asio::steady_timer drain_timer_;
+    std::chrono::steady_clock::time_point drain_deadline_;
+    std::function<void()> on_drained_;
     ChatRoomManager room_manager_;  // 멤버 변수로 사용하려면 실제 타입이 필요
+    UserRegistry user_registry_;    // 접속 중인 사용자 이름 -> 세션
+    
+    // 추가 수락 루프용 io_context (세션보다 방/사용자 관리자가 오래 살도록 뒤에 선언)
+    std::vector<std::unique_ptr<boost::asio::io_context>> worker_contexts_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+    std::vector<std::thread> worker_threads_;
+    
+    // 중계 서버 연결 (사용하지 않으면 nullptr)
+    std::unique_ptr<RelayLink> relay_link_;
+    
+    // 코어별 샤드 (사용하지 않으면 nullptr) - 샤드에 있는 세션이 방/사용자 관리자보다 먼저 정리되도록 뒤에 선언
+    std::unique_ptr<CoreShards> core_shards_;
+    std::atomic<size_t> next_shard_{0};  // 새 연결을 돌아가며 배정
+    
+    // 로컬 봇/사이드카용 Unix 도메인 소켓 (첫 번째 수락 루프와 같은 io_context)
+    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> unix_acceptor_;
 };
 
 } // namespace wagle
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include "util/name_table.h"
+
+namespace wagle {
+
+class Session;
+
+// 접속 중인 사용자 이름 -> 세션 색인
+// 이름 ID로 나눈 샤드마다 락을 두어 로그인/로그아웃이 서로 다른 샤드끼리는 경합하지 않으며,
+// 이름으로 세션을 바로 찾을 수 있어 귓속말 등 대상 지정 전송에 사용된다.
+class UserRegistry {
+public:
+    using clock = std::chrono::steady_clock;
+    
+    // resume_window: 연결이 끊긴 뒤 재개 토큰이 유효한 시간 (0이면 재개 사용 안 함)
+    explicit UserRegistry(std::chrono::seconds resume_window = std::chrono::seconds(0))
+        : resume_window_(resume_window) {}
+    
+    // 이름 선점 (이미 사용 중이거나 끊긴 세션의 재개 토큰이 아직 유효하면 false)
+    bool claim(NameId name_id, const std::shared_ptr<Session>& session);
+
+    // 이름 해제 (해당 세션이 소유한 경우에만) - 재개 토큰은 resume_window 동안 유지
+    void release(NameId name_id, const Session* session);
+
+    // 세션 재개 토큰 발급 (재개를 사용하지 않으면 빈 문자열, 같은 이름의 이전 토큰은 무효화)
+    // 토큰이 유효한 동안 이름을 유지하므로 연결이 끊긴 뒤에도 같은 이름이 같은 ID를 받음
+    std::string issueResumeToken(const NameRef& name, const std::shared_ptr<Session>& session);
+
+    // 재개 토큰으로 이름을 넘겨받음 (토큰이 맞지 않으면 false, 토큰은 한 번만 사용 가능)
+    // 끊긴 것을 아직 모르는 이전 세션이 남아 있으면 previous로 돌려줌 (호출한 쪽에서 종료)
+    // 이름을 가진 세션이 토큰을 받은 세션이 아니면 넘겨받지 않고 false
+    bool resume(NameId name_id, const std::string& token, const std::shared_ptr<Session>& session,
+                std::shared_ptr<Session>& previous);
+
+    // 이름으로 세션 찾기 (없거나 이미 종료된 세션이면 nullptr)
+    std::shared_ptr<Session> find(NameId name_id) const;
+
+    // 접속 중인 모든 세션 (서버 종료 시 연결 정리용)
+    std::vector<std::shared_ptr<Session>> snapshot() const;
+
+    // 접속 중인 사용자 수
+    size_t size() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct ResumeToken {
+        std::string token;
+        clock::time_point expires;  // 접속 중이면 time_point::max()
+        NameRef name;
+        std::weak_ptr<Session> owner;  // 토큰을 받은 세션
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<NameId, std::weak_ptr<Session>> sessions;
+        std::unordered_map<NameId, ResumeToken> tokens;
+    };
+
+    Shard& shardFor(NameId name_id) { return shards_[name_id % SHARD_COUNT]; }
+    const Shard& shardFor(NameId name_id) const { return shards_[name_id % SHARD_COUNT]; }
+
+    std::chrono::seconds resume_window_;
+    Shard shards_[SHARD_COUNT];
+    std::atomic<size_t> count_{0};
+};
+
+} // namespace wagle
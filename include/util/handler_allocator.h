@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace wagle {
+
+// 비동기 작업 완료 핸들러용 재사용 메모리
+// 한 번에 하나만 진행되는 작업(세션의 읽기, 쓰기)마다 하나씩 두면
+// 정상 상태에서는 핸들러를 할당할 때 malloc을 거치지 않는다. 크기가 넘치거나 사용 중이면 힙 사용
+// 할당과 해제가 서로 다른 스레드에서 일어날 수 있으므로(다른 스레드가 세션에 넘긴 작업) 사용 표시는 원자적 값
+class HandlerMemory {
+public:
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+    
+    void* allocate(std::size_t size);
+    void deallocate(void* pointer);
+    
+private:
+    static const std::size_t CAPACITY = 1024;
+    
+    typename std::aligned_storage<CAPACITY>::type storage_;
+    std::atomic<bool> in_use_{false};
+};
+
+// HandlerMemory에서 할당하는 표준 할당자 (asio가 associated_allocator로 찾아 씀)
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+    
+    explicit HandlerAllocator(HandlerMemory& memory) : memory_(memory) {}
+    
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+    
+    bool operator==(const HandlerAllocator& other) const noexcept { return &memory_ == &other.memory_; }
+    bool operator!=(const HandlerAllocator& other) const noexcept { return &memory_ != &other.memory_; }
+    
+    T* allocate(std::size_t n) const { return static_cast<T*>(memory_.allocate(sizeof(T) * n)); }
+    void deallocate(T* pointer, std::size_t /*n*/) const { memory_.deallocate(pointer); }
+    
+private:
+    template <typename> friend class HandlerAllocator;
+    
+    HandlerMemory& memory_;
+};
+
+// 핸들러에 할당자를 붙인 래퍼
+template <typename Handler>
+class AllocatingHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+    
+    AllocatingHandler(HandlerMemory& memory, Handler handler)
+        : memory_(memory), handler_(std::move(handler)) {}
+    
+    allocator_type get_allocator() const noexcept { return allocator_type(memory_); }
+    
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+    
+private:
+    HandlerMemory& memory_;
+    Handler handler_;
+};
+
+// 예: async_read_until(socket, buffer, '\n', withAllocator(read_memory_, [..](..) {..}))
+template <typename Handler>
+inline AllocatingHandler<typename std::decay<Handler>::type> withAllocator(HandlerMemory& memory, Handler&& handler) {
+    return AllocatingHandler<typename std::decay<Handler>::type>(memory, std::forward<Handler>(handler));
+}
+
+} // namespace wagle
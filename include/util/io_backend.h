@@ -0,0 +1,12 @@
+#pragma once
+
+namespace wagle {
+
+// 이 빌드의 소켓 I/O 백엔드 이름 ("io_uring" 또는 "epoll")
+const char* ioBackendName();
+
+// 실행 중인 커널에서 io_uring을 쓸 수 있는지 확인 (링을 하나 만들어 보고 바로 닫음)
+// 커널이 오래되었거나 seccomp 등으로 막혀 있으면 false
+bool ioUringAvailable();
+
+} // namespace wagle
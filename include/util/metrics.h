@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace wagle {
+
+// 스레드별 샤드 수 (스레드마다 다른 캐시 라인에 기록해 경합을 없앰)
+static const std::size_t METRIC_SHARDS = 16;
+
+// 현재 스레드의 샤드 번호
+std::size_t metricShardIndex();
+
+// 단조 증가 카운터
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[metricShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[METRIC_SHARDS];
+};
+
+// 늘고 주는 현재 값 (카운터처럼 스레드별 샤드에 증감분을 기록하고 읽을 때 합산)
+class Gauge {
+public:
+    void add(int64_t n = 1) {
+        shards_[metricShardIndex()].delta.fetch_add(n, std::memory_order_relaxed);
+    }
+    void sub(int64_t n = 1) {
+        shards_[metricShardIndex()].delta.fetch_sub(n, std::memory_order_relaxed);
+    }
+    int64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> delta{0};
+    };
+    Shard shards_[METRIC_SHARDS];
+};
+
+// 한 곳에서 값을 통째로 기록하는 게이지 (드물게 바뀌므로 샤드 없이 원자적 값 하나)
+class ValueGauge {
+public:
+    void set(int64_t n) { value_.store(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// 2의 거듭제곱 구간으로 나눈 히스토그램 (나노초 단위 관측값)
+class Histogram {
+public:
+    static const std::size_t BUCKETS = 24;  // 1us ~ 약 8s, 마지막은 +Inf
+
+    void observe(uint64_t value);
+
+    // Prometheus 텍스트 형식으로 출력 (나노초 값을 초 단위로 변환)
+    void render(std::string& out, const char* name, const char* help) const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[BUCKETS] = {};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> count{0};
+    };
+    Shard shards_[METRIC_SHARDS];
+};
+
+// 서버 전체 지표
+struct ServerMetrics {
+    Counter messages_in;        // 수신한 메시지 수
+    Counter messages_out;       // 전송한 메시지 수 (브로드캐스트는 수신자 수만큼)
+    Counter bytes_in;           // 수신한 바이트 수
+    Counter bytes_out;          // 전송한 바이트 수
+    Counter parse_errors;       // 해석할 수 없는 메시지 수
+    Counter frames_dropped;     // 크기 제한으로 버린 메시지 수
+    Counter rate_limited;       // 처리율 제한으로 거절한 요청 수
+    Counter timeouts;           // 응답이 없어 끊은 연결 수
+    Counter slow_consumers;     // 송신 큐가 넘쳐 끊은 연결 수
+    Counter direct_messages;    // 전달한 개인 메시지 수
+    Counter rooms_reaped;       // 오래 비어 있어 정리한 방 수
+    Counter session_migrations; // 방을 맡은 코어 샤드로 옮겨 간 세션 수
+    Counter core_queue_full;    // 코어 샤드의 작업 큐가 가득 차 거절한 요청 수
+    Counter allocations;        // 전역 operator new 호출 수 (WAGLE_COUNT_ALLOCATIONS 빌드에서만 집계)
+    Gauge sessions;             // 현재 연결 수
+    ValueGauge rooms;           // 현재 채팅방 수
+    Gauge outbound_queue;       // 모든 연결의 송신 대기 메시지 수
+    Gauge names;                // 이름 테이블에 등록된 이름 수
+    Histogram broadcast_time;   // 브로드캐스트 한 번에 걸린 시간
+
+    // Prometheus 텍스트 형식으로 출력
+    std::string render() const;
+};
+
+// 전역 지표 객체
+ServerMetrics& metrics();
+
+} // namespace wagle
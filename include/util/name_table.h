@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wagle {
+
+// 채팅방 이름/사용자 이름을 대신하는 정수 ID (0은 빈 이름)
+using NameId = uint32_t;
+constexpr NameId EMPTY_NAME_ID = 0;
+
+class NameRef;
+
+// 이름 인터닝 테이블
+// 같은 이름은 참조가 남아 있는 동안 항상 같은 ID를 받으며, 서버 내부에서는 ID로 비교/해시하고
+// 전송할 때만 문자열로 되돌린다. 참조(NameRef)가 모두 사라지면 이름을 지우고 ID를 재사용하므로
+// 테이블 크기는 지금 쓰이는 이름 수를 넘지 않는다.
+class NameTable {
+public:
+    NameTable();
+    ~NameTable();
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    // 이름의 참조 (없으면 새로 등록). 빈 이름이거나 테이블이 가득 차면 빈 참조
+    NameRef acquire(const std::string& name);
+
+    // 이미 등록된 이름의 ID 반환 (없으면 EMPTY_NAME_ID, 새로 등록하지 않음)
+    NameId find(const std::string& name) const;
+
+    // 새 이름을 더 등록할 수 없는지
+    bool full() const;
+
+    // ID의 이름 반환 (락 없음, 그 ID의 참조를 가지고 있는 동안 유효)
+    const std::string& name(NameId id) const { return slot(id).name; }
+
+private:
+    friend class NameRef;
+
+    static const int CHUNK_BITS = 12;
+    static const std::size_t CHUNK_SIZE = 1 << CHUNK_BITS;  // 청크당 이름 수
+    static const std::size_t MAX_CHUNKS = 1024;             // 동시에 최대 약 400만 개
+    static const std::size_t SHARD_COUNT = 16;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, NameId> ids;
+    };
+
+    struct Slot {
+        std::string name;
+        uint32_t refs = 0;   // 참조 수 (shard의 mutex 보호)
+        uint8_t shard = 0;   // 이름이 등록된 샤드
+    };
+
+    Slot& slot(NameId id) const {
+        return chunks_[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+    static std::size_t shardIndex(const std::string& name);
+    NameId store(const std::string& name, std::size_t shard);  // 빈 ID에 이름 기록 (가득 차면 EMPTY_NAME_ID)
+
+    // 참조 수 증감 (호출한 쪽이 참조를 가지고 있어야 함, 0이 되면 ID 반환)
+    void retain(NameId id);
+    void release(NameId id);
+
+    Shard shards_[SHARD_COUNT];
+    mutable std::mutex store_mutex_;
+    NameId next_id_ = 1;
+    std::vector<NameId> free_ids_;  // 해제되어 다시 쓸 수 있는 ID
+    // 이름 저장소 - 청크는 한 번 할당되면 옮겨지지 않으므로 참조가 안정적임
+    std::atomic<Slot*> chunks_[MAX_CHUNKS] = {};
+};
+
+// 전역 이름 테이블
+NameTable& names();
+
+// 이름 ID의 참조 - 가지고 있는 동안 이름이 지워지거나 ID가 다른 이름에 재사용되지 않음
+// 이름을 오래 보관하는 곳(사용자, 채팅방, 재개 토큰, 알리지 않은 입장/퇴장)이 가짐
+class NameRef {
+public:
+    NameRef() = default;
+    NameRef(const NameRef& other) : id_(other.id_) {
+        if (id_ != EMPTY_NAME_ID) {
+            names().retain(id_);
+        }
+    }
+    NameRef(NameRef&& other) noexcept : id_(other.id_) { other.id_ = EMPTY_NAME_ID; }
+    NameRef& operator=(NameRef other) noexcept {
+        std::swap(id_, other.id_);
+        return *this;
+    }
+    ~NameRef() {
+        if (id_ != EMPTY_NAME_ID) {
+            names().release(id_);
+        }
+    }
+
+    NameId id() const { return id_; }
+    const std::string& name() const { return names().name(id_); }
+    explicit operator bool() const { return id_ != EMPTY_NAME_ID; }
+
+private:
+    friend class NameTable;
+    explicit NameRef(NameId retained_id) : id_(retained_id) {}  // 이미 늘린 참조를 넘겨받음
+
+    NameId id_ = EMPTY_NAME_ID;
+};
+
+} // namespace wagle
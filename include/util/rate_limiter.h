@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace wagle {
+
+// 토큰 버킷 한도 설정 (런타임에 변경 가능)
+struct RateLimit {
+    std::atomic<uint32_t> rate;   // 초당 보충되는 토큰 수 (0이면 제한 없음)
+    std::atomic<uint32_t> burst;  // 한 번에 허용되는 최대 요청 수
+
+    RateLimit(uint32_t r, uint32_t b) : rate(r), burst(b) {}
+
+    void set(uint32_t r, uint32_t b) {
+        rate.store(r, std::memory_order_relaxed);
+        burst.store(b, std::memory_order_relaxed);
+    }
+};
+
+// 락 없는 토큰 버킷
+// 토큰 수 대신 "다음 토큰이 도착할 이론적 시각" 하나만 원자적으로 관리한다 (GCRA)
+class TokenBucket {
+public:
+    // 토큰 하나 소비 시도 (한도 초과 시 false)
+    bool tryConsume(const RateLimit& limit);
+    
+    // tryConsume으로 소비한 토큰 하나를 되돌림 (여러 한도를 함께 확인하다 뒤의 것이 넘쳤을 때)
+    void refund(const RateLimit& limit);
+
+private:
+    std::atomic<int64_t> tat_{0};  // theoretical arrival time (ns)
+};
+
+} // namespace wagle
@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace wagle {
+
+// 계층형 타이밍 휠
+// 타이머 등록/취소는 O(1)이며, 하나의 주기 타이머로 수많은 세션의 만료 시각을 관리한다.
+// 스레드 안전하지 않으므로 휠을 구동하는 io_context 스레드에서만 사용해야 한다.
+class TimerWheel {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // 휠에 등록되는 타이머 (소유자 객체에 내장하여 등록 시 메모리 할당이 없음)
+    struct Entry {
+        std::function<void()> callback;  // 만료 시 호출 (한 번만 설정)
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+        uint64_t expires = 0;  // 만료 틱
+
+        Entry() = default;
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        bool isArmed() const { return next != nullptr; }
+    };
+
+    explicit TimerWheel(std::chrono::milliseconds tick);
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 타이머 등록 (이미 등록되어 있으면 만료 시각만 갱신)
+    void arm(Entry& entry, std::chrono::milliseconds timeout);
+
+    // 타이머 취소
+    void cancel(Entry& entry);
+
+    // 현재 시각까지 휠을 진행하며 만료된 타이머 실행
+    void advance(clock::time_point now);
+
+    std::chrono::milliseconds getTick() const { return tick_; }
+
+private:
+    static const int LEVEL_BITS = 6;
+    static const int SLOTS = 1 << LEVEL_BITS;  // 단계당 슬롯 수
+    static const int LEVELS = 4;               // 64^4 틱까지 표현
+
+    void link(Entry& entry);
+    static void unlink(Entry& entry);
+    void cascade(int level);
+    void step();
+
+    std::chrono::milliseconds tick_;
+    clock::time_point start_;
+    uint64_t current_tick_ = 0;
+    Entry slots_[LEVELS][SLOTS];  // 슬롯별 원형 리스트의 헤더
+};
+
+} // namespace wagle
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// 핫 패스 지연 추적
+// WAGLE_ENABLE_TRACING으로 빌드했을 때만 추적 지점이 기록되며, 그렇지 않으면 매크로가 모두 사라진다.
+// 각 스레드는 자신의 링 버퍼에만 기록하므로 락이 없고, dump()로 Chrome trace-event JSON을 쓴다.
+
+namespace wagle {
+namespace trace {
+
+// 현재 타임스탬프 (x86에서는 TSC, 그 외에는 steady_clock 나노초)
+uint64_t now();
+
+// 완료된 구간 하나를 현재 스레드의 링 버퍼에 기록
+void record(const char* name, uint64_t begin, uint64_t end);
+
+// 모든 스레드의 기록을 Chrome trace-event JSON 파일로 저장
+bool dump(const std::string& path);
+
+// 생성부터 소멸까지를 하나의 구간으로 기록
+class Span {
+public:
+    explicit Span(const char* name) : name_(name), begin_(now()) {}
+    ~Span() { record(name_, begin_, now()); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;  // 문자열 리터럴만 사용
+    uint64_t begin_;
+};
+
+} // namespace trace
+} // namespace wagle
+
+#define WAGLE_TRACE_CONCAT_IMPL(a, b) a##b
+#define WAGLE_TRACE_CONCAT(a, b) WAGLE_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef WAGLE_ENABLE_TRACING
+#define WAGLE_TRACE_SPAN(name) ::wagle::trace::Span WAGLE_TRACE_CONCAT(wagle_trace_span_, __LINE__)(name)
+#else
+#define WAGLE_TRACE_SPAN(name) ((void)0)
+#endif
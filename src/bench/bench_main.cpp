@@ -0,0 +1,653 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <unistd.h>
+#include "chat/chat_room.h"
+#include "chat/loopback_user.h"
+#include "protocol/message.h"
+#include "util/metrics.h"
+#include "util/name_table.h"
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+// 부하 생성기 설정
+struct BenchConfig {
+    std::string mode = "room";             // room: 채팅방 브로드캐스트, direct: 개인 메시지, fanout: 서버 없이 방 전송만
+    std::string host = "127.0.0.1";
+    std::vector<unsigned short> ports;     // 여러 개면 클라이언트를 돌아가며 배정 (클러스터)
+    std::string unix_socket;               // 지정하면 TCP 대신 이 Unix 도메인 소켓으로 접속
+    std::size_t clients = 100;
+    std::size_t rooms = 1;                 // room 모드에서 클라이언트를 나눠 넣을 방 수
+    std::size_t senders = 0;               // 메시지를 보내는 클라이언트 수 (0이면 전부)
+    std::size_t messages = 1000;           // 보내는 클라이언트 하나당 메시지 수
+    std::size_t size = 32;                 // 메시지 내용 길이
+    std::size_t window = 16;               // 자기 메시지가 돌아오기 전에 더 보낼 수 있는 수
+    std::chrono::seconds timeout{60};
+    unsigned short metrics_port = 0;       // 지정하면 실행 전후 서버 지표 차이를 출력
+    std::size_t threads = 1;               // fanout 모드에서 방 전송을 나눠 맡을 스레드 수
+    std::size_t churn = 0;                 // fanout 모드에서 브로드캐스트마다 나갔다 다시 들어오는 사용자 수
+};
+
+class Bench;
+
+// 서버에 접속한 가상 사용자 하나
+class BenchClient : public std::enable_shared_from_this<BenchClient> {
+public:
+    using Socket = boost::asio::generic::stream_protocol::socket;
+    using Endpoint = boost::asio::generic::stream_protocol::endpoint;
+
+    BenchClient(boost::asio::io_context& io_context, Bench& bench, std::size_t index)
+        : socket_(io_context), bench_(bench), index_(index) {}
+
+    void start(const Endpoint& endpoint);
+
+    // 창(window)이 허락하는 만큼 보냄 - 측정을 시작할 때와 자기 메시지가 돌아올 때 호출
+    void sendMore();
+
+    std::size_t index() const { return index_; }
+    std::size_t received() const { return received_; }
+    std::size_t expected = 0;      // 받아야 할 채팅/개인 메시지 수
+    std::size_t to_send = 0;       // 보낼 메시지 수
+    std::string name;
+    std::string target;            // room 모드는 방 이름, direct 모드는 받는 사람 이름
+
+private:
+    void readFrame();
+    void handle(const std::string& line);
+    void write(std::string frame);
+    void writeQueued();
+
+    Socket socket_;
+    Bench& bench_;
+    std::size_t index_;
+    boost::asio::streambuf buffer_;
+    std::deque<std::string> write_queue_;
+    bool writing_ = false;
+    std::size_t received_ = 0;
+    std::size_t sent_ = 0;
+    std::deque<Clock::time_point> in_flight_;  // 보냈지만 아직 돌아오지 않은 메시지의 전송 시각
+};
+
+// 클라이언트들을 접속시키고 모두 준비되면 측정을 시작해 결과를 출력
+class Bench {
+public:
+    Bench(boost::asio::io_context& io_context, const BenchConfig& config)
+        : io_context_(io_context), config_(config), timer_(io_context),
+          content_(config.size, 'x') {}
+
+    bool run();
+
+    const BenchConfig& config() const { return config_; }
+    const std::string& content() const { return content_; }
+
+    void onReady();
+    void onSent() { ++sent_; }
+    void onDelivered(const BenchClient& client);
+    void onEcho(Clock::duration latency) {
+        latencies_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+    void fail(const std::string& reason);
+
+private:
+    void assign();
+    void finish();
+    void report();
+
+    boost::asio::io_context& io_context_;
+    const BenchConfig& config_;
+    boost::asio::steady_timer timer_;
+    std::string content_;
+    std::vector<std::shared_ptr<BenchClient>> clients_;
+    std::size_t ready_ = 0;
+    std::size_t done_ = 0;         // 받을 메시지를 모두 받은 클라이언트 수
+    std::size_t sent_ = 0;
+    std::size_t delivered_ = 0;
+    std::size_t expected_ = 0;
+    std::vector<uint64_t> latencies_;
+    Clock::time_point started_;
+    Clock::time_point finished_;
+    bool failed_ = false;
+};
+
+// 지표 엔드포인트에서 "이름 값" 줄을 읽어 옴 (히스토그램 구간처럼 레이블이 붙은 줄은 제외)
+static std::map<std::string, double> scrape_metrics(const std::string& host, unsigned short port) {
+    std::map<std::string, double> values;
+    boost::asio::io_context io_context;
+    tcp::resolver resolver(io_context);
+    tcp::socket socket(io_context);
+    boost::asio::connect(socket, resolver.resolve(host, std::to_string(port)));
+    std::string request = "GET /metrics HTTP/1.0\r\nHost: " + host + "\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(request));
+
+    std::string response;
+    boost::system::error_code ec;
+    char chunk[4096];
+    for (;;) {
+        std::size_t n = socket.read_some(boost::asio::buffer(chunk), ec);
+        if (ec) {
+            break;
+        }
+        response.append(chunk, n);
+    }
+
+    std::istringstream lines(response.substr(std::min(response.find("\r\n\r\n"), response.size())));
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty() || line[0] == '#' || line.find('{') != std::string::npos) {
+            continue;
+        }
+        size_t space = line.find(' ');
+        if (space != std::string::npos) {
+            values[line.substr(0, space)] = std::stod(line.substr(space + 1));
+        }
+    }
+    return values;
+}
+
+void BenchClient::start(const Endpoint& endpoint) {
+    auto self(shared_from_this());
+    socket_.async_connect(endpoint, [this, self](boost::system::error_code ec) {
+        if (ec) {
+            bench_.fail("connect failed: " + ec.message());
+            return;
+        }
+        socket_.set_option(tcp::no_delay(true), ec);  // Unix 소켓이면 실패하며 무시됨
+        write(wagle::Message(wagle::MessageType::CONNECT, name, "").serialize());
+        readFrame();
+    });
+}
+
+void BenchClient::sendMore() {
+    const BenchConfig& config = bench_.config();
+    wagle::MessageType type = (config.mode == "direct") ? wagle::MessageType::DIRECT_MSG
+                                                        : wagle::MessageType::CHAT_MSG;
+    while (sent_ < to_send && in_flight_.size() < config.window) {
+        write(wagle::Message(type, name, bench_.content(), target).serialize());
+        in_flight_.push_back(Clock::now());
+        ++sent_;
+        bench_.onSent();
+    }
+}
+
+void BenchClient::readFrame() {
+    auto self(shared_from_this());
+    boost::asio::async_read_until(socket_, buffer_, '\n',
+        [this, self](boost::system::error_code ec, std::size_t length) {
+            if (ec) {
+                bench_.fail(name + " disconnected: " + ec.message());
+                return;
+            }
+            std::string line(boost::asio::buffers_begin(buffer_.data()),
+                             boost::asio::buffers_begin(buffer_.data()) + length - 1);
+            buffer_.consume(length);
+            handle(line);
+            readFrame();
+        });
+}
+
+void BenchClient::handle(const std::string& line) {
+    // 받는 쪽 처리 비용이 서버 측정을 가리지 않도록 타입과 보낸 사람만 잘라 봄
+    size_t first = line.find(':');
+    size_t second = (first == std::string::npos) ? first : line.find(':', first + 1);
+    if (second == std::string::npos) {
+        return;
+    }
+    auto type = static_cast<wagle::MessageType>(std::stoi(line.substr(0, first)));
+    std::string sender = line.substr(first + 1, second - first - 1);
+
+    switch (type) {
+        case wagle::MessageType::CONNECT:
+            if (sender != "SERVER" || line.find("Connection successful") == std::string::npos) {
+                break;  // 방 입장 알림
+            }
+            if (bench_.config().mode == "direct") {
+                bench_.onReady();
+            } else {
+                // 방이 이미 있으면 생성은 실패하므로 결과와 관계없이 입장
+                write(wagle::Message(wagle::MessageType::ROOM_CREATE, name, target).serialize());
+                write(wagle::Message(wagle::MessageType::ROOM_JOIN, name, target).serialize());
+            }
+            break;
+
+        case wagle::MessageType::ROOM_JOIN:
+            bench_.onReady();
+            break;
+
+        case wagle::MessageType::ROOM_ERROR:
+            if (line.find("already exists") == std::string::npos) {
+                bench_.fail(name + ": " + line);
+            }
+            break;
+
+        case wagle::MessageType::CHAT_MSG:
+        case wagle::MessageType::DIRECT_MSG:
+            if (sender == "SERVER") {
+                break;
+            }
+            ++received_;
+            if (sender == name && !in_flight_.empty()) {
+                bench_.onEcho(Clock::now() - in_flight_.front());
+                in_flight_.pop_front();
+                sendMore();
+            }
+            bench_.onDelivered(*this);
+            break;
+
+        case wagle::MessageType::PING:
+            write(wagle::Message(wagle::MessageType::PONG, name, "").serialize());
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BenchClient::write(std::string frame) {
+    write_queue_.push_back(std::move(frame));
+    if (!writing_) {
+        writeQueued();
+    }
+}
+
+void BenchClient::writeQueued() {
+    writing_ = true;
+    auto self(shared_from_this());
+    boost::asio::async_write(socket_, boost::asio::buffer(write_queue_.front()),
+        [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+            if (ec) {
+                writing_ = false;
+                return;
+            }
+            write_queue_.pop_front();
+            if (write_queue_.empty()) {
+                writing_ = false;
+                return;
+            }
+            writeQueued();
+        });
+}
+
+bool Bench::run() {
+    assign();
+
+    std::vector<BenchClient::Endpoint> endpoints;
+    if (!config_.unix_socket.empty()) {
+        endpoints.emplace_back(boost::asio::local::stream_protocol::endpoint(config_.unix_socket));
+    } else {
+        tcp::resolver resolver(io_context_);
+        for (unsigned short port : config_.ports) {
+            endpoints.emplace_back(resolver.resolve(config_.host, std::to_string(port)).begin()->endpoint());
+        }
+    }
+
+    std::map<std::string, double> before;
+    if (config_.metrics_port != 0) {
+        before = scrape_metrics(config_.host, config_.metrics_port);
+    }
+
+    for (const auto& client : clients_) {
+        client->start(endpoints[client->index() % endpoints.size()]);
+    }
+    timer_.expires_after(config_.timeout);
+    timer_.async_wait([this](boost::system::error_code ec) {
+        if (!ec) {
+            fail("timed out");
+        }
+    });
+    io_context_.run();
+
+    report();
+    if (config_.metrics_port != 0) {
+        auto after = scrape_metrics(config_.host, config_.metrics_port);
+        std::cout << "server metrics (delta, per delivered message):" << std::endl;
+        for (const auto& value : after) {
+            double delta = value.second - before[value.first];
+            bool counter = value.first.size() > 6 &&
+                           value.first.compare(value.first.size() - 6, 6, "_total") == 0;
+            if (!counter || delta == 0) {
+                continue;
+            }
+            double per_message = delta / std::max<std::size_t>(delivered_, 1);
+            std::cout << "  " << std::left << std::setw(40) << value.first << std::right << std::fixed;
+            if (value.first.find("_seconds_total") != std::string::npos) {
+                // 시간은 메시지당 마이크로초로 표시
+                std::cout << std::setw(14) << std::setprecision(3) << delta
+                          << std::setw(12) << per_message * 1e6 << " us";
+            } else {
+                std::cout << std::setw(14) << std::setprecision(0) << delta
+                          << std::setw(12) << std::setprecision(3) << per_message;
+            }
+            std::cout << std::endl;
+        }
+    }
+    return !failed_;
+}
+
+void Bench::assign() {
+    // 보내는 클라이언트와 받을 메시지 수를 미리 정해 둠
+    std::size_t pid = getpid();
+    std::size_t senders = (config_.senders == 0) ? config_.clients : std::min(config_.senders, config_.clients);
+    for (std::size_t i = 0; i < config_.clients; ++i) {
+        auto client = std::make_shared<BenchClient>(io_context_, *this, i);
+        client->name = "bench" + std::to_string(pid) + "_" + std::to_string(i);
+        client->to_send = (i < senders) ? config_.messages : 0;
+        clients_.push_back(client);
+    }
+
+    if (config_.mode == "direct") {
+        // 다음 번호의 클라이언트에게 보냄 - 보낸 사람도 자기 메시지를 돌려받음
+        for (std::size_t i = 0; i < clients_.size(); ++i) {
+            auto& recipient = clients_[(i + 1) % clients_.size()];
+            clients_[i]->target = recipient->name;
+            clients_[i]->expected += clients_[i]->to_send;
+            if (recipient != clients_[i]) {
+                recipient->expected += clients_[i]->to_send;
+            }
+        }
+    } else {
+        // 방 하나의 사용자는 그 방의 모든 메시지(자기 메시지 포함)를 받음
+        std::size_t rooms = std::max<std::size_t>(1, std::min(config_.rooms, config_.clients));
+        std::vector<std::size_t> room_messages(rooms, 0);
+        for (const auto& client : clients_) {
+            std::size_t room = client->index() % rooms;
+            client->target = "bench" + std::to_string(pid) + "_room" + std::to_string(room);
+            room_messages[room] += client->to_send;
+        }
+        for (const auto& client : clients_) {
+            client->expected = room_messages[client->index() % rooms];
+        }
+    }
+
+    for (const auto& client : clients_) {
+        expected_ += client->expected;
+        if (client->expected == 0) {
+            ++done_;
+        }
+    }
+}
+
+void Bench::onReady() {
+    if (++ready_ < clients_.size()) {
+        return;
+    }
+    started_ = Clock::now();
+    for (const auto& client : clients_) {
+        client->sendMore();
+    }
+    if (expected_ == 0) {
+        finish();
+    }
+}
+
+void Bench::onDelivered(const BenchClient& client) {
+    ++delivered_;
+    if (client.received() == client.expected && ++done_ == clients_.size()) {
+        finish();
+    }
+}
+
+void Bench::fail(const std::string& reason) {
+    if (failed_ || io_context_.stopped()) {
+        return;
+    }
+    std::cerr << "Benchmark failed: " << reason << std::endl;
+    if (reason.find("Rate limit") != std::string::npos) {
+        std::cerr << "Start the server with --chat-limit=0 --room-chat-limit=0" << std::endl;
+    }
+    failed_ = true;
+    finish();
+}
+
+void Bench::finish() {
+    finished_ = Clock::now();
+    timer_.cancel();
+    io_context_.stop();
+}
+
+void Bench::report() {
+    double seconds = std::chrono::duration<double>(finished_ - started_).count();
+    if (started_ == Clock::time_point() || seconds <= 0) {
+        std::cout << "no messages measured (" << ready_ << "/" << clients_.size() << " clients ready)" << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "mode=" << config_.mode << " clients=" << clients_.size();
+    if (config_.mode == "room") {
+        std::cout << " rooms=" << config_.rooms;
+    }
+    std::cout << " messages=" << config_.messages << " size=" << config_.size
+              << " window=" << config_.window << std::endl;
+    std::cout << "sent " << sent_ << " in " << seconds << "s ("
+              << std::setprecision(0) << sent_ / seconds << " msg/s)" << std::endl;
+    std::cout << "delivered " << delivered_ << "/" << expected_ << " ("
+              << delivered_ / seconds << " msg/s)" << std::endl;
+
+    if (!latencies_.empty()) {
+        std::sort(latencies_.begin(), latencies_.end());
+        auto at = [this](double q) {
+            return latencies_[std::min(latencies_.size() - 1, static_cast<std::size_t>(q * latencies_.size()))] / 1e6;
+        };
+        std::cout << std::setprecision(3) << "echo latency ms: p50 " << at(0.5) << " p99 " << at(0.99)
+                  << " max " << latencies_.back() / 1e6 << std::endl;
+    }
+}
+
+// 서버 없이 한 채팅방에 프로세스 내 사용자를 넣고 브로드캐스트 - 커널과 소켓을 빼고 방 전송 비용만 측정
+static void run_fanout(const BenchConfig& config) {
+    // --threads가 2 이상이면 서버처럼 스레드마다 io_context를 두고 스트랜드를 거쳐 순서대로 나눠 전송
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+    std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> guards;
+    std::vector<std::thread> workers;
+    wagle::FanoutPool pool;
+    if (config.threads > 1) {
+        pool.min_room_size = 1;
+        for (std::size_t i = 0; i < config.threads; ++i) {
+            contexts.push_back(std::make_unique<boost::asio::io_context>());
+            auto strand = boost::asio::make_strand(*contexts.back());
+            pool.executors.push_back([strand](std::function<void()> task) {
+                boost::asio::post(strand, std::move(task));
+            });
+            guards.push_back(boost::asio::make_work_guard(*contexts.back()));
+            workers.emplace_back([context = contexts.back().get()]() { context->run(); });
+        }
+    }
+
+    // 실행기에 넘긴 전송이 모두 끝날 때까지 기다림 (실행기는 받은 순서대로 실행하므로 마지막 작업만 확인)
+    auto drain = [&pool]() {
+        for (const auto& executor : pool.executors) {
+            std::promise<void> done;
+            executor([&done]() { done.set_value(); });
+            done.get_future().wait();
+        }
+    };
+
+    wagle::ChatRoom room(wagle::names().acquire("bench"), nullptr, &pool);
+    std::vector<std::shared_ptr<wagle::LoopbackUser>> members;
+    members.reserve(config.clients);
+    // --churn을 쓰면 사용자마다 마지막으로 받은 순번을 기록해 다시 들어올 때 그 이후만 받고, 중복이나 역순 수신을 셈
+    std::unique_ptr<std::atomic<uint64_t>[]> last_seqs(new std::atomic<uint64_t>[config.clients]());
+    std::atomic<uint64_t> misordered{0};
+    std::atomic<uint64_t> gaps{0};
+    for (std::size_t i = 0; i < config.clients; ++i) {
+        wagle::LoopbackUser::Handler on_frame;
+        if (config.churn > 0) {
+            on_frame = [&last_seq = last_seqs[i], &misordered, &gaps](const wagle::User::Frame& frame) {
+                // 순번은 CHAT_MSG의 마지막 필드
+                if (frame->compare(0, 2, "2:") != 0) {
+                    return;
+                }
+                uint64_t seq = std::strtoull(frame->c_str() + frame->rfind(':') + 1, nullptr, 10);
+                uint64_t last = last_seq.load(std::memory_order_relaxed);
+                if (seq <= last) {
+                    misordered.fetch_add(1, std::memory_order_relaxed);
+                } else if (seq != last + 1) {
+                    gaps.fetch_add(1, std::memory_order_relaxed);
+                }
+                last_seq.store(seq, std::memory_order_relaxed);
+            };
+        }
+        auto member = std::make_shared<wagle::LoopbackUser>(wagle::names().acquire("member" + std::to_string(i)),
+                                                            std::move(on_frame));
+        room.join(member);
+        members.push_back(std::move(member));
+    }
+    room.flushPending();
+    drain();
+
+    // 입장 알림과 사용자 수 메시지는 측정에서 뺌
+    auto delivered_frames = [&members]() {
+        uint64_t frames = 0;
+        for (const auto& member : members) {
+            frames += member->getFrameCount();
+        }
+        return frames;
+    };
+    uint64_t before = delivered_frames();
+
+    std::string content(config.size, 'x');
+#ifdef WAGLE_COUNT_ALLOCATIONS
+    uint64_t allocations = wagle::metrics().allocations.value();
+#endif
+    auto started = Clock::now();
+    for (std::size_t i = 0; i < config.messages; ++i) {
+        // 브로드캐스트 사이에 --churn명이 나갔다 다시 들어옴 (퇴장한 뒤에는 이전 입장의 전송이 오지 않으므로 기록한 순번이 정확함)
+        for (std::size_t c = 0; c < config.churn && !members.empty(); ++c) {
+            std::size_t index = (i * config.churn + c) % members.size();
+            room.leave(members[index]);
+            room.join(members[index], last_seqs[index].load(std::memory_order_relaxed));
+        }
+        room.broadcast(wagle::MessageType::CHAT_MSG, "bench", content);
+    }
+    drain();
+    double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+#ifdef WAGLE_COUNT_ALLOCATIONS
+    allocations = wagle::metrics().allocations.value() - allocations;
+#endif
+
+    uint64_t delivered = delivered_frames() - before;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "mode=fanout members=" << members.size() << " messages=" << config.messages
+              << " size=" << config.size << " threads=" << std::max<std::size_t>(config.threads, 1)
+              << " churn=" << config.churn << std::endl;
+    std::cout << "broadcast " << config.messages << " in " << seconds << "s ("
+              << seconds * 1e3 / std::max<std::size_t>(config.messages, 1) << " ms per message)" << std::endl;
+    std::cout << "delivered " << delivered << " (" << std::setprecision(0) << delivered / seconds << " frames/s, "
+              << std::setprecision(1) << seconds * 1e9 / std::max<uint64_t>(delivered, 1) << " ns per frame)"
+              << std::endl;
+    if (config.churn > 0) {
+        // 모든 사용자가 마지막 메시지까지 빠짐없이 한 번씩 받았는지 확인
+        uint64_t incomplete = 0;
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            if (last_seqs[i].load(std::memory_order_relaxed) != config.messages) {
+                incomplete++;
+            }
+        }
+        std::cout << "out of order or duplicate " << misordered.load() << ", gaps " << gaps.load()
+                  << ", members missing the last message " << incomplete << std::endl;
+    }
+#ifdef WAGLE_COUNT_ALLOCATIONS
+    std::cout << "allocations " << allocations << " (" << std::setprecision(2)
+              << static_cast<double>(allocations) / std::max<std::size_t>(config.messages, 1) << " per message)"
+              << std::endl;
+#endif
+
+    guards.clear();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// --이름=값 형식의 옵션 처리 (알 수 없는 옵션이면 false)
+static bool parse_option(const std::string& arg, BenchConfig& config) {
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+        return false;
+    }
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+
+    if (name == "host") {
+        config.host = value;
+    } else if (name == "port") {
+        // 쉼표로 여러 포트를 나열하면 클라이언트를 돌아가며 배정
+        std::istringstream ports(value);
+        std::string port;
+        while (std::getline(ports, port, ',')) {
+            config.ports.push_back(std::stoi(port));
+        }
+    } else if (name == "unix") {
+        config.unix_socket = value;
+    } else if (name == "clients") {
+        config.clients = std::stoul(value);
+    } else if (name == "rooms") {
+        config.rooms = std::stoul(value);
+    } else if (name == "senders") {
+        config.senders = std::stoul(value);
+    } else if (name == "messages") {
+        config.messages = std::stoul(value);
+    } else if (name == "size") {
+        config.size = std::stoul(value);
+    } else if (name == "window") {
+        config.window = std::max<std::size_t>(1, std::stoul(value));
+    } else if (name == "timeout") {
+        config.timeout = std::chrono::seconds(std::stoul(value));
+    } else if (name == "metrics-port") {
+        config.metrics_port = std::stoi(value);
+    } else if (name == "threads") {
+        config.threads = std::stoul(value);
+    } else if (name == "churn") {
+        config.churn = std::stoul(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchConfig config;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") == 0) {
+                if (!parse_option(arg, config)) {
+                    std::cerr << "Unknown option: " << arg << std::endl;
+                    return 1;
+                }
+            } else {
+                config.mode = arg;
+            }
+        }
+        if (config.mode != "room" && config.mode != "direct" && config.mode != "fanout") {
+            std::cerr << "Unknown mode: " << config.mode << " (room, direct, fanout)" << std::endl;
+            return 1;
+        }
+        if (config.mode == "fanout") {
+            run_fanout(config);
+            return 0;
+        }
+        if (config.ports.empty()) {
+            config.ports.push_back(8080);
+        }
+
+        boost::asio::io_context io_context;
+        Bench bench(io_context, config);
+        return bench.run() ? 0 : 1;
+    }
+    catch (std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -3,6 +3,10 @@
 #include <thread>
 #include <deque>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <charconv>
 #include <boost/asio.hpp>
 #include <ncurses.h>
 #include <locale.h>
@@ -46,6 +50,7 @@ struct RoomInfo {
 };
 
 std::vector<RoomInfo> room_list;
+uint64_t room_list_version = 0;  // 마지막으로 적용한 채팅방 목록 버전
 int selected_room_index = 0;
 
 // 입력 포커스를 입력창으로 이동시키는 함수
@@ -61,6 +66,14 @@ void set_focus_to_input() {
 // 현재 사용자 수
 int current_user_count = 0;
 
+// 문자열 전체가 숫자일 때만 value에 저장 (서버가 보낸 값을 예외 없이 검사)
+template <typename T>
+bool parse_number(const std::string& text, T& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
 // 타임스탬프 함수
 std::string get_timestamp() {
     time_t now = time(nullptr);
@@ -327,6 +340,20 @@ void print_chat_message(const std::string& sender, const std::string& content) {
     }
 }
 
+// 개인 메시지 표시 함수
+void print_direct_message(const std::string& sender, const std::string& recipient, const std::string& content) {
+    if (chat_win) {
+        std::string timestamp = get_timestamp();
+        
+        wattron(chat_win, COLOR_PAIR(COLOR_PAIR_MY_MESSAGE));
+        wprintw(chat_win, "[%s] (DM) %s -> %s: %s\n", timestamp.c_str(), sender.c_str(), recipient.c_str(), content.c_str());
+        wattroff(chat_win, COLOR_PAIR(COLOR_PAIR_MY_MESSAGE));
+        
+        wrefresh(chat_win);
+        set_focus_to_input();
+    }
+}
+
 // 시스템 메시지 표시 함수
 void print_system_message(const std::string& message) {
     if (chat_win) {
@@ -343,35 +370,49 @@ void print_system_message(const std::string& message) {
 
 class ChatClient {
 public:
-    ChatClient(boost::asio::io_context& io_context, const tcp::resolver::results_type& endpoints)
-        : io_context_(io_context), socket_(io_context), connected_(false) {
-        connect(endpoints);
+    // 연결이 끊기면 서버 주소를 다시 조회해 재접속하며, 그동안 보낸 메시지는 모아 두었다가 재접속 후 전송
+    ChatClient(boost::asio::io_context& io_context, const std::string& host, const std::string& port)
+        : io_context_(io_context), work_(boost::asio::make_work_guard(io_context)), resolver_(io_context),
+          socket_(io_context), reconnect_timer_(io_context), host_(host), port_(port),
+          jitter_(std::random_device{}()) {
+        boost::asio::post(io_context_, [this]() { connect(); });
     }
     
+    // 서버에 연결되어 있는지 (사용자 이름 확인 전 포함)
     bool is_connected() const {
-        return connected_;
+        State state = state_;
+        return state != State::CONNECTING && state != State::CLOSED;
     }
     
     void close() {
         boost::asio::post(io_context_, [this]() { 
-            connected_ = false;
-            socket_.close(); 
+            state_ = State::CLOSED;
+            work_.reset();
+            reconnect_timer_.cancel();
+            resolver_.cancel();
+            boost::system::error_code ignored;
+            socket_.close(ignored);
         });
     }
     
     void write(const wagle::Message& msg) {
         boost::asio::post(io_context_,
             [this, msg]() {
-                bool write_in_progress = !write_msgs_.empty();
+                // 재접속 중에도 보낸 메시지는 모아 둠 (너무 많이 쌓이면 버림)
+                if (write_msgs_.size() >= MAX_PENDING_WRITES) {
+                    print_system_message("Not connected, message dropped");
+                    return;
+                }
                 write_msgs_.push_back(msg);
-                if (!write_in_progress) {
+                if (state_ == State::READY && !writing_) {
                     writeImpl();
                 }
             });
     }
     
+    // 처음 접속할 때의 사용자 이름 확인 (메인 스레드에서 동기식으로 주고받은 뒤 수신 시작)
     bool validate_username(const std::string& username, std::string& error_message) {
-        if (!connected_) {
+        if (!is_connected()) {
             error_message = "서버에 연결되어 있지 않습니다.";
             return false;
         }
@@ -392,15 +433,14 @@ public:
             return false;
         }
         
-        boost::asio::streambuf response;
-        boost::asio::read_until(socket_, response, '\n', ec);
+        boost::asio::read_until(socket_, buffer_, '\n', ec);
         
         if (ec) {
             error_message = "서버 응답 오류: " + ec.message();
             return false;
         }
         
-        std::istream is(&response);
+        std::istream is(&buffer_);
         std::string data;
         std::getline(is, data);
         
@@ -411,12 +451,24 @@ public:
             return false;
         }
         
+        // 로그인 완료 - 이후 송수신은 IO 스레드에서
+        boost::asio::post(io_context_, [this, username, token = response_msg.getRoomName()]() {
+            username_ = username;
+            resume_token_ = token;
+            onLoggedIn();
+        });
         return true;
     }
     
-    // 채팅방 목록 요청
-    void request_room_list() {
-        wagle::Message msg(wagle::MessageType::ROOM_LIST, current_username, "");
+    // 채팅방 목록 구독 (전체 목록을 받은 뒤 변경분만 받음)
+    void subscribe_room_list() {
+        wagle::Message msg(wagle::MessageType::ROOM_SUBSCRIBE, current_username, "1");
+        write(msg);
+    }
+    
+    // 채팅방 목록 구독 해제
+    void unsubscribe_room_list() {
+        wagle::Message msg(wagle::MessageType::ROOM_SUBSCRIBE, current_username, "0");
         write(msg);
     }
     
@@ -433,17 +485,136 @@ public:
     }
     
 private:
-    void connect(const tcp::resolver::results_type& endpoints) {
-        boost::asio::async_connect(socket_, endpoints,
-            [this](boost::system::error_code ec, tcp::endpoint) {
-                if (!ec) {
-                    connected_ = true;
-                    readMessages();
-                } else {
-                    connected_ = false;
-                    print_system_message("Connect failed: " + ec.message());
+    enum class State {
+        CONNECTING,   // 연결 시도 중 (재접속 대기 포함)
+        CONNECTED,    // 연결됨, 처음 사용자 이름 확인 전
+        HANDSHAKING,  // 재접속 후 로그인 응답 대기
+        READY,        // 로그인 완료 - 모아 둔 메시지 전송
+        CLOSED        // 종료
+    };
+    
+    // 재접속 간격: 0 ~ min(상한, 기본 * 2^시도 횟수) 사이 무작위 (서버 재시작 후 클라이언트가 한꺼번에 몰리지 않도록)
+    static constexpr std::chrono::milliseconds RECONNECT_BASE{500};
+    static constexpr std::chrono::milliseconds RECONNECT_CAP{30000};
+    static const size_t MAX_PENDING_WRITES = 1000;
+    
+    void connect() {
+        resolver_.async_resolve(host_, port_,
+            [this](boost::system::error_code ec, tcp::resolver::results_type endpoints) {
+                if (state_ == State::CLOSED) {
+                    return;
+                }
+                if (ec) {
+                    scheduleReconnect();
+                    return;
+                }
+                boost::asio::async_connect(socket_, endpoints,
+                    [this](boost::system::error_code ec, tcp::endpoint) {
+                        if (state_ == State::CLOSED) {
+                            return;
+                        }
+                        if (ec) {
+                            scheduleReconnect();
+                            return;
+                        }
+                        onConnected();
+                    });
+            });
+    }
+    
+    void scheduleReconnect() {
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        
+        auto limit = std::min<std::chrono::milliseconds::rep>(
+            RECONNECT_CAP.count(), RECONNECT_BASE.count() << std::min(reconnect_attempts_, 16));
+        std::uniform_int_distribution<std::chrono::milliseconds::rep> delay(0, limit);
+        reconnect_attempts_++;
+        
+        reconnect_timer_.expires_after(std::chrono::milliseconds(delay(jitter_)));
+        reconnect_timer_.async_wait([this](boost::system::error_code ec) {
+            if (!ec && state_ != State::CLOSED) {
+                connect();
+            }
+        });
+    }
+    
+    void onConnected() {
+        buffer_.consume(buffer_.size());
+        
+        // 처음 접속이면 메인 스레드에서 사용자 이름을 확인
+        if (username_.empty()) {
+            state_ = State::CONNECTED;
+            return;
+        }
+        
+        // 재접속 - 재개 토큰으로 같은 이름과 놓친 메시지를 되찾음
+        state_ = State::HANDSHAKING;
+        handshake_ = wagle::Message(wagle::MessageType::CONNECT, username_, resume_token_).serialize();
+        boost::asio::async_write(socket_, boost::asio::buffer(handshake_),
+            [this](boost::system::error_code ec, std::size_t /*length*/) {
+                if (ec) {
+                    connectionLost("Write failed: " + ec.message());
                 }
             });
+        readMessages();
+    }
+    
+    void onLoggedIn() {
+        if (state_ == State::CLOSED) {
+            return;
+        }
+        bool reconnected = (state_ == State::HANDSHAKING);
+        state_ = State::READY;
+        reconnect_attempts_ = 0;
+        
+        if (reconnected) {
+            print_system_message("Reconnected");
+            // 서버 쪽 세션 상태를 끊기기 전으로 되돌린 뒤 모아 둔 메시지 전송
+            if (subscribed_) {
+                write_msgs_.push_front(wagle::Message(wagle::MessageType::ROOM_SUBSCRIBE, username_, "1"));
+            }
+            if (!joined_room_.empty()) {
+                wagle::Message rejoin(wagle::MessageType::ROOM_JOIN, username_, joined_room_);
+                rejoin.setSeq(last_seq_);
+                write_msgs_.push_front(rejoin);
+            }
+        } else {
+            readMessages();
+        }
+        if (!write_msgs_.empty() && !writing_) {
+            writeImpl();
+        }
+    }
+    
+    void connectionLost(const std::string& reason) {
+        if (state_ == State::CLOSED || state_ == State::CONNECTING) {
+            return;
+        }
+        state_ = State::CONNECTING;
+        print_system_message(reason + " - reconnecting...");
+        scheduleReconnect();
+    }
+    
+    // 서버가 처리한 요청으로 재접속 때 되돌릴 상태 갱신
+    void onSent(const wagle::Message& msg) {
+        switch (msg.getType()) {
+            case wagle::MessageType::ROOM_JOIN:
+                if (msg.getContent() != joined_room_) {
+                    joined_room_ = msg.getContent();
+                    last_seq_ = 0;
+                }
+                break;
+            case wagle::MessageType::ROOM_LEAVE:
+                joined_room_.clear();
+                last_seq_ = 0;
+                break;
+            case wagle::MessageType::ROOM_SUBSCRIBE:
+                subscribed_ = (msg.getContent() == "1");
+                break;
+            default:
+                break;
+        }
     }
     
     void readMessages() {
@@ -456,23 +627,70 @@ private:
                     
                     wagle::Message msg = wagle::Message::deserialize(data);
                     
+                    // 재접속 후 로그인 응답
+                    if (state_ == State::HANDSHAKING) {
+                        if (msg.getType() == wagle::MessageType::CONNECT) {
+                            resume_token_ = msg.getRoomName();
+                            onLoggedIn();
+                        } else if (msg.getType() == wagle::MessageType::DISCONNECT) {
+                            // 이전 연결이 아직 이름을 쥐고 있음 - 서버가 정리할 때까지 다시 시도
+                            resume_token_.clear();
+                            connectionLost("Login failed: " + msg.getContent());
+                            return;
+                        }
+                        readMessages();
+                        return;
+                    }
+                    
                     switch (msg.getType()) {
                         case wagle::MessageType::CHAT_MSG:
+                            // 재접속 시 이 순번 이후만 다시 받음
+                            if (msg.getRoomName() == joined_room_ && msg.getSeq() > last_seq_) {
+                                last_seq_ = msg.getSeq();
+                            }
                             print_chat_message(msg.getSender(), msg.getContent());
                             break;
                             
+                        case wagle::MessageType::DIRECT_MSG:
+                            print_direct_message(msg.getSender(), msg.getRoomName(), msg.getContent());
+                            break;
+                            
                         case wagle::MessageType::CONNECT:
                         case wagle::MessageType::DISCONNECT:
                             print_system_message(msg.getContent());
                             break;
                             
                         case wagle::MessageType::USER_COUNT:
-                            update_user_count(std::stoi(msg.getContent()));
+                        {
+                            int count = 0;
+                            if (parse_number(msg.getContent(), count)) {
+                                update_user_count(count);
+                            }
                             break;
+                        }
                             
                         case wagle::MessageType::ROOM_LIST:
+                        {
+                            // 버전을 읽지 못하면 0으로 두어 다음 변경분에서 전체 목록을 다시 받게 함
+                            uint64_t version = 0;
+                            if (!msg.getRoomName().empty() && !parse_number(msg.getRoomName(), version)) {
+                                version = 0;
+                            }
+                            room_list_version = version;
                             handle_room_list_response(msg.getContent());
                             break;
+                        }
+                            
+                        case wagle::MessageType::ROOM_LIST_DELTA:
+                        {
+                            uint64_t version = 0;
+                            if (parse_number(msg.getRoomName(), version)) {
+                                handle_room_list_delta(version, msg.getContent());
+                            } else {
+                                subscribe_room_list();
+                            }
+                            break;
+                        }
                             
                         case wagle::MessageType::ROOM_JOIN:
                             current_room = msg.getRoomName();
@@ -483,80 +701,149 @@ private:
                             print_system_message("Error: " + msg.getContent());
                             break;
                             
+                        case wagle::MessageType::PING:
+                            write(wagle::Message(wagle::MessageType::PONG, current_username, ""));
+                            break;
+                            
                         default:
                             break;
                     }
                     
                     readMessages();
                 } else {
-                    connected_ = false;
-                    print_system_message("Read failed: " + ec.message());
-                    socket_.close();
+                    connectionLost("Read failed: " + ec.message());
                 }
             });
     }
     
+    // ';'로 구분된 항목을 하나씩 처리
+    template <typename Handler>
+    static void for_each_entry(const std::string& data, Handler handler) {
+        size_t start = 0;
+        while (start < data.size()) {
+            size_t pos = data.find(';', start);
+            if (pos == std::string::npos) {
+                pos = data.size();
+            }
+            if (pos > start) {
+                handler(data.substr(start, pos - start));
+            }
+            start = pos + 1;
+        }
+    }
+    
     void handle_room_list_response(const std::string& data) {
         room_list.clear();
         
-        if (data.empty()) return;
-        
-        std::string data_copy = data;
-        std::string token;
-        
-        while (!data_copy.empty()) {
-            size_t pos = data_copy.find(';');
-            
-            if (pos != std::string::npos) {
-                token = data_copy.substr(0, pos);
-                data_copy = data_copy.substr(pos + 1);
-            } else {
-                token = data_copy;
-                data_copy.clear();
-            }
-            
-            if (token.empty()) continue;
-            
+        for_each_entry(data, [](const std::string& token) {
             // room_name,user_count,is_default 형식 파싱
             size_t comma1 = token.find(',');
             size_t comma2 = token.find(',', comma1 + 1);
             
             if (comma1 != std::string::npos && comma2 != std::string::npos) {
                 std::string name = token.substr(0, comma1);
-                int count = std::stoi(token.substr(comma1 + 1, comma2 - comma1 - 1));
+                int count = 0;
+                if (!parse_number(token.substr(comma1 + 1, comma2 - comma1 - 1), count)) {
+                    return;
+                }
                 bool is_default = (token.substr(comma2 + 1) == "1");
                 
                 room_list.emplace_back(name, count, is_default);
             }
-        }
+        });
         
         // 채팅방 목록 화면 갱신
         display_room_list();
     }
     
+    void handle_room_list_delta(uint64_t version, const std::string& data) {
+        // 중간 변경분을 놓쳤으면 전체 목록부터 다시 받음
+        if (version != room_list_version + 1) {
+            subscribe_room_list();
+            return;
+        }
+        room_list_version = version;
+        
+        for_each_entry(data, [](const std::string& token) {
+            // +이름,사용자 수,기본 방 여부 / -이름 / =이름,사용자 수
+            char op = token[0];
+            size_t comma1 = token.find(',');
+            std::string name = token.substr(1, comma1 == std::string::npos ? std::string::npos : comma1 - 1);
+            
+            // 서버와 같은 이름순 유지
+            auto it = std::lower_bound(room_list.begin(), room_list.end(), name,
+                                       [](const RoomInfo& room, const std::string& n) { return room.name < n; });
+            bool found = (it != room_list.end() && it->name == name);
+            
+            if (op == '-') {
+                if (found) {
+                    room_list.erase(it);
+                }
+            } else if (comma1 != std::string::npos) {
+                size_t comma2 = token.find(',', comma1 + 1);
+                int count = 0;
+                if (!parse_number(token.substr(comma1 + 1, comma2 == std::string::npos ? std::string::npos : comma2 - comma1 - 1), count)) {
+                    return;
+                }
+                if (found) {
+                    it->user_count = count;
+                } else if (op == '+') {
+                    bool is_default = (comma2 != std::string::npos && token.substr(comma2 + 1) == "1");
+                    room_list.insert(it, RoomInfo(name, count, is_default));
+                }
+            }
+        });
+        
+        if (selected_room_index >= (int)room_list.size()) {
+            selected_room_index = room_list.empty() ? 0 : (int)room_list.size() - 1;
+        }
+        display_room_list();
+    }
+    
     void writeImpl() {
-        std::string serialized_msg = write_msgs_.front().serialize();
+        // 전송이 끝날 때까지 버퍼 유지
+        writing_ = true;
+        write_buffer_ = write_msgs_.front().serialize();
         boost::asio::async_write(socket_,
-            boost::asio::buffer(serialized_msg),
+            boost::asio::buffer(write_buffer_),
             [this](boost::system::error_code ec, std::size_t /*length*/) {
+                writing_ = false;
                 if (!ec) {
+                    onSent(write_msgs_.front());
                     write_msgs_.pop_front();
-                    if (!write_msgs_.empty()) {
+                    if (state_ == State::READY && !write_msgs_.empty()) {
                         writeImpl();
                     }
                 } else {
-                    connected_ = false;
-                    print_system_message("Write failed: " + ec.message());
-                    socket_.close();
+                    // 보내지 못한 메시지는 큐에 남겨 재접속 후 다시 보냄
+                    connectionLost("Write failed: " + ec.message());
                 }
             });
     }
     
     boost::asio::io_context& io_context_;
+    // 사용자 이름 입력을 기다리는 동안처럼 진행 중인 작업이 없어도 IO 스레드 유지
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    tcp::resolver resolver_;
     tcp::socket socket_;
+    boost::asio::steady_timer reconnect_timer_;
+    std::string host_;
+    std::string port_;
     boost::asio::streambuf buffer_;
     std::deque<wagle::Message> write_msgs_;
-    bool connected_;
+    std::string write_buffer_;
+    bool writing_ = false;
+    std::atomic<State> state_{State::CONNECTING};
+    
+    // 재접속 상태 (IO 스레드 전용)
+    std::string username_;
+    std::string resume_token_;
+    std::string handshake_;
+    std::string joined_room_;  // 서버에 입장 요청을 보낸 방 (재접속 시 다시 입장)
+    uint64_t last_seq_ = 0;    // joined_room_에서 마지막으로 받은 메시지 순번
+    bool subscribed_ = false;  // 채팅방 목록 구독 중
+    int reconnect_attempts_ = 0;
+    std::mt19937 jitter_;
 };
 
 void reset_all_windows() {
@@ -588,15 +875,13 @@ int main(int argc, char* argv[]) {
         if (argc > 2) port = argv[2];
         
         boost::asio::io_context io_context;
-        tcp::resolver resolver(io_context);
-        auto endpoints = resolver.resolve(host, port);
-        
-        ChatClient client(io_context, endpoints);
+        ChatClient client(io_context, host, port);
         
         std::thread io_thread([&io_context]() { io_context.run(); });
         
+        // 처음 연결은 재접속과 같은 간격으로 재시도하며 최대 10초 대기
         int retry_count = 0;
-        while (!client.is_connected() && retry_count < 5) {
+        while (!client.is_connected() && retry_count < 100) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             retry_count++;
         }
@@ -645,7 +930,7 @@ int main(int argc, char* argv[]) {
         while (true) {
             // 채팅방 목록 화면으로 전환
             setup_room_list_screen();
-            client.request_room_list();
+            client.subscribe_room_list();
             
             // 잠시 대기하여 방 목록 로드 완료
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -671,13 +956,14 @@ int main(int argc, char* argv[]) {
                         break;
                     case 'r':
                     case 'R':
-                        client.request_room_list();
+                        client.subscribe_room_list();
                         std::this_thread::sleep_for(std::chrono::milliseconds(100));
                         display_room_list();
                         break;
                     case '\n':
                     case '\r':
                         if (!room_list.empty() && selected_room_index < (int)room_list.size()) {
+                            client.unsubscribe_room_list();
                             client.join_room(room_list[selected_room_index].name);
                             room_selected = true;
                         }
@@ -694,10 +980,9 @@ int main(int argc, char* argv[]) {
                             noecho();
                             
                             if (strlen(room_name_buf) > 0) {
+                                // 새 방은 구독 중인 목록의 변경분으로 들어옴
                                 client.create_room(std::string(room_name_buf));
-                                std::this_thread::sleep_for(std::chrono::milliseconds(200));
-                                client.request_room_list();
-                                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                                std::this_thread::sleep_for(std::chrono::milliseconds(300));
                             }
                             
                             delwin(room_create_win);
@@ -731,7 +1016,7 @@ int main(int argc, char* argv[]) {
                 wmove(input_win, 1, 2);
                 wclrtoeol(input_win);
                 box(input_win, 0, 0);
-                mvwprintw(input_win, 0, 2, " 💬 Input (/quit to exit, /rooms to return to room list) ");
+                mvwprintw(input_win, 0, 2, " 💬 Input (/quit to exit, /rooms to return to room list, /w <user> <msg> to whisper) ");
                 
                 set_focus_to_input();
                 
@@ -752,6 +1037,15 @@ int main(int argc, char* argv[]) {
                 } else if (line == "/rooms") {
                     client.write(wagle::Message(wagle::MessageType::ROOM_LEAVE, current_username, ""));
                     return_to_rooms = true;
+                } else if (line.compare(0, 3, "/w ") == 0) {
+                    // 개인 메시지: /w 받는사람 내용
+                    size_t space = line.find(' ', 3);
+                    if (space != std::string::npos && space > 3) {
+                        client.write(wagle::Message(wagle::MessageType::DIRECT_MSG, current_username,
+                                                    line.substr(space + 1), line.substr(3, space - 3)));
+                    } else {
+                        print_system_message("Usage: /w <username> <message>");
+                    }
                 } else {
                     client.write(wagle::Message(wagle::MessageType::CHAT_MSG, current_username, line));
                 }
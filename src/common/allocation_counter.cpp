@@ -0,0 +1,34 @@
+#include <cstdlib>
+#include <new>
+#include "util/metrics.h"
+
+// WAGLE_COUNT_ALLOCATIONS 빌드에서는 전역 operator new를 바꿔 할당 횟수를 wagle_allocations_total로 집계
+// (배열/nothrow 버전은 표준 라이브러리가 이 함수를 거쳐 할당하므로 함께 집계됨)
+#ifdef WAGLE_COUNT_ALLOCATIONS
+
+void* operator new(std::size_t size) {
+    wagle::metrics().allocations.add();
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void* pointer = std::malloc(size)) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+    std::free(pointer);
+}
+
+#endif
@@ -1,121 +1,338 @@
 #include "chat/chat_room.h"
-#include <iostream>
-#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <mutex>
+#include "util/metrics.h"
+#include "util/trace.h"
 
 namespace wagle {
 
-// 뮤텍스 추가 - 여러 스레드에서 동시에 채팅방에 접근할 때 데이터 보호
-std::mutex chat_room_mutex;
+// 입장/퇴장 알림에 이름을 나열하는 최대 인원 (넘으면 인원수만 표시)
+static const size_t PRESENCE_NAMES_LISTED = 3;
 
-void ChatRoom::join(std::shared_ptr<User> user) {
-    std::unique_lock<std::mutex> lock(chat_room_mutex);
+User::Frame ChatRoom::serverFrame(MessageType type, const std::string& content) const {
+    return std::make_shared<const std::string>(Message(type, "SERVER", content, getName()).serialize());
+}
+
+void ChatRoom::remember(HistoryEntry entry) {
+    if (!recent_messages_) {
+        recent_messages_ = std::make_unique<std::deque<HistoryEntry>>();
+    }
+    recent_messages_->push_back(std::move(entry));
+    while (recent_messages_->size() > MAX_RECENT_MESSAGES) {
+        recent_messages_->pop_front();
+    }
+}
+
+// 모아 둔 입장/퇴장 사용자를 한 줄로 요약 (예: "12 users joined the chat.")
+static std::string presenceText(const ChatRoom::PendingNames& names, const char* action) {
+    if (names.size() == 1) {
+        return names.begin()->second.name() + " has " + action + " the chat.";
+    }
+    if (names.size() > PRESENCE_NAMES_LISTED) {
+        return std::to_string(names.size()) + " users " + action + " the chat.";
+    }
     
-    // 사용자 추가
-    users_.insert(user);
+    std::string text;
+    size_t i = 0;
+    for (const auto& entry : names) {
+        if (i > 0) {
+            text += (i + 1 == names.size()) ? " and " : ", ";
+        }
+        text += entry.second.name();
+        ++i;
+    }
+    return text + " " + action + " the chat.";
+}
+
+bool ChatRoom::join(std::shared_ptr<User> user, uint64_t after_seq) {
+    std::unique_lock<std::mutex> lock(mutex_);
     
-    // 사용자 입장 메시지 생성
-    Message join_msg(MessageType::CONNECT, "SERVER", user->getName() + " has joined the chat.");
+    // 정리 중인 방에는 입장 불가
+    if (closed_) {
+        return false;
+    }
     
-    // 다른 사용자들에게만 입장 메시지 전송 (본인 제외)
-    for (auto& other_user : users_) {
-        if (other_user != user) {  // 본인을 제외한 다른 사용자들에게만 메시지 전송
-            try {
-                boost::asio::write(other_user->getSocket(), boost::asio::buffer(join_msg.serialize()));
-            } catch (std::exception& e) {
-                std::cerr << "Error sending join message: " << e.what() << std::endl;
-            }
+    // 사용자 추가 - 입장 알림과 사용자 수는 모아서 보냄
+    std::shared_ptr<Member> member;
+    if (fanout_ && fanout_->enabled()) {
+        member = std::make_shared<Member>(user);
+        if (!lanes_.empty()) {
+            addToLane(member);
         }
     }
+    users_.emplace(user, std::move(member));
+    count_dirty_ = true;
     
-    // 메시지 저장 (이후 입장하는 사용자들이 볼 수 있게)
-    recent_messages_.push_back(join_msg);
-    while (recent_messages_.size() > MAX_RECENT_MESSAGES) {
-        recent_messages_.pop_front();
+    // 알리기 전에 나갔다 다시 들어온 경우는 서로 상쇄
+    if (pending_leaves_.erase(user->getNameId()) == 0) {
+        pending_joins_.emplace(user->getNameId(), user->getNameRef());
     }
     
-    // 락 잠시 해제 - 최근 메시지 전송 중 데드락 방지
-    lock.unlock();
-    
-    // 최근 메시지 전송 (새로 입장한 사용자에게)
-    // 새로운 락 범위 시작
-    {
-        std::unique_lock<std::mutex> read_lock(chat_room_mutex);
-        for (const auto& msg : recent_messages_) {
-            // 본인의 입장 메시지는 제외하고 전송
-            if (!(msg.getType() == MessageType::CONNECT && 
-                msg.getContent() == user->getName() + " has joined the chat.")) {
-                try {
-                    boost::asio::write(user->getSocket(), boost::asio::buffer(msg.serialize()));
-                } catch (std::exception& e) {
-                    std::cerr << "Error sending recent message: " << e.what() << std::endl;
-                }
-            }
+    // 최근 메시지 전송 (새로 입장한 사용자에게) - 입장/퇴장 알림은 기록에 남기지 않으므로 대화만 전송
+    // 받은 적 있는 순번 이후만 보냄 (방이 정리 후 다시 만들어져 순번이 더 작으면 전부 보냄)
+    if (recent_messages_) {
+        if (after_seq > last_seq_) {
+            after_seq = 0;
+        }
+        auto first = std::upper_bound(recent_messages_->begin(), recent_messages_->end(), after_seq,
+                                      [](uint64_t seq, const HistoryEntry& entry) { return seq < entry.seq; });
+        for (auto it = first; it != recent_messages_->end(); ++it) {
+            user->deliver(it->frame);
         }
     }
+    lock.unlock();
     
-    // 사용자 수 업데이트 브로드캐스트
-    broadcastUserCount();
+    if (on_count_change_) {
+        on_count_change_(name_);
+    }
+    return true;
 }
 
 void ChatRoom::leave(std::shared_ptr<User> user) {
-    std::unique_lock<std::mutex> lock(chat_room_mutex);
-    // 닉네임 기준으로 사용자 제거
-    auto it = std::find_if(users_.begin(), users_.end(), [&](const std::shared_ptr<User>& u) {
-        return u->getName() == user->getName();
-    });
+    std::unique_lock<std::mutex> lock(mutex_);
+    // 같은 이름이라도 다른 연결의 사용자는 제거하지 않음 (재접속한 세션이 먼저 입장했을 수 있음)
+    auto it = users_.find(user);
     if (it == users_.end()) {
         return;
     }
+    if (auto member = it->second) {
+        // 실행기에서 진행 중인 전송이 끝나기를 기다렸다가 닫음 - 반환한 뒤에는 이 방의 이전 메시지가 가지 않음
+        {
+            std::lock_guard<std::mutex> member_lock(member->mutex);
+            member->present = false;
+        }
+        if (!lanes_.empty()) {
+            removeFromLane(member);
+        }
+    }
     users_.erase(it);
-    lock.unlock();  // 락 해제 - broadcast가 내부적으로 락을 획득하므로
+    count_dirty_ = true;
+    if (users_.empty()) {
+        empty_since_ = clock::now();
+    }
     
-    // 사용자 퇴장 메시지
-    Message leave_msg(MessageType::DISCONNECT, "SERVER", user->getName() + " has left the chat.");
-    broadcast(leave_msg);
+    // 퇴장 알림도 모아서 보냄 (알리기 전에 들어왔다 나간 경우는 상쇄)
+    if (pending_joins_.erase(user->getNameId()) == 0) {
+        pending_leaves_.emplace(user->getNameId(), user->getNameRef());
+    }
+    lock.unlock();
     
-    // 사용자 수 업데이트 브로드캐스트
-    broadcastUserCount();
+    if (on_count_change_) {
+        on_count_change_(name_);
+    }
 }
 
-void ChatRoom::broadcast(const Message& msg) {
-    std::unique_lock<std::mutex> lock(chat_room_mutex);
+void ChatRoom::broadcast(MessageType type, const std::string& sender, const std::string& content,
+                         std::shared_ptr<Recipients> recipients) {
+    WAGLE_TRACE_SPAN("room.broadcast");
+    auto start = std::chrono::steady_clock::now();
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    // 순번은 락 안에서 매겨야 사용자가 받는 순서와 일치함
+    Message msg(type, sender, content, getName());
+    msg.setSeq(++last_seq_);
+    auto serialized_msg = std::make_shared<const std::string>(msg.serialize());
     
-    // 메시지 저장
-    recent_messages_.push_back(msg);
+    // 메시지 저장 (보낸 버퍼를 공유)
+    remember(HistoryEntry{last_seq_, serialized_msg});
+    
+    // 모든 사용자의 송신 큐에 같은 버퍼를 넣음 - 실제 소켓 쓰기는 각 세션에서 비동기로 처리
+    // 알리지 않은 입장/퇴장과 사용자 수 변경이 있으면 따로 보내지 않고 이 메시지 앞에 붙여 보냄
+    fanOut(takePendingFrames(), serialized_msg, recipients);
+    lock.unlock();
     
-    // 최대 메시지 수 유지
-    while (recent_messages_.size() > MAX_RECENT_MESSAGES) {
-        recent_messages_.pop_front();
+    metrics().broadcast_time.observe(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+void ChatRoom::PendingFrames::deliverTo(User& user) const {
+    // 혼자 입장한 사용자에게는 자기 입장 알림을 보내지 않음
+    if (joined && user.getNameId() != lone_joiner) {
+        user.deliver(joined);
+    }
+    if (left) {
+        user.deliver(left);
+    }
+    if (count) {
+        user.deliver(count);
+    }
+}
+
+ChatRoom::PendingFrames ChatRoom::takePendingFrames() {
+    PendingFrames pending;
+    if (!pending_joins_.empty()) {
+        pending.joined = serverFrame(MessageType::CONNECT, presenceText(pending_joins_, "joined"));
+        if (pending_joins_.size() == 1) {
+            pending.lone_joiner = pending_joins_.begin()->first;
+        }
+        pending_joins_.clear();
+    }
+    if (!pending_leaves_.empty()) {
+        pending.left = serverFrame(MessageType::DISCONNECT, presenceText(pending_leaves_, "left"));
+        pending_leaves_.clear();
+    }
+    if (count_dirty_) {
+        pending.count = userCountFrame();
+        count_dirty_ = false;
+    }
+    return pending;
+}
+
+User::Frame ChatRoom::userCountFrame() const {
+    // 여러 방에 입장한 연결이 구분할 수 있도록 방 이름을 붙임
+    return serverFrame(MessageType::USER_COUNT, std::to_string(users_.size()));
+}
+
+void ChatRoom::flushPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PendingFrames pending = takePendingFrames();
+    if (!pending.joined && !pending.left && !pending.count) {
+        return;
     }
     
-    // 모든 사용자에게 전송
-    std::string serialized_msg = msg.serialize();
-    for (auto& user : users_) {
-        try {
-            boost::asio::write(user->getSocket(), boost::asio::buffer(serialized_msg));
-        } catch (std::exception& e) {
-            std::cerr << "Error broadcasting message: " << e.what() << std::endl;
-            // 오류 발생 시 로그만 기록하고 계속 진행 - 연결 끊어진 사용자는 다른 부분에서 처리됨
+    // 모든 사용자에게 같은 메시지 전송
+    fanOut(std::move(pending), nullptr);
+}
+
+void ChatRoom::fanOut(PendingFrames pending, const User::Frame& frame, const std::shared_ptr<Recipients>& recipients) {
+    WAGLE_TRACE_SPAN("room.fanout");
+    
+    // 작은 방은 호출한 스레드에서 바로 전송
+    // 나눠 보낸 전송이 아직 끝나지 않았으면 방이 작아졌어도 순서를 지키기 위해 계속 나눠서 보냄
+    bool parallel = fanout_ && fanout_->enabled() &&
+                    (users_.size() >= fanout_->min_room_size ||
+                     (lanes_in_flight_ && lanes_in_flight_->load(std::memory_order_acquire) > 0));
+    if (!parallel) {
+        for (auto& entry : users_) {
+            User& user = *entry.first;
+            pending.deliverTo(user);
+            if (frame && (!recipients || recipients->claim(user.getNameId()))) {
+                user.deliver(frame);
+            }
         }
+        return;
+    }
+    
+    if (lanes_.empty()) {
+        startLanes();
+    }
+    
+    // 실행기마다 자기 몫의 사용자에게 전송 (메시지 버퍼는 모두 공유)
+    // 실행기별 목록은 그 실행기 스레드의 것이므로 비어 있는지 여기서 보지 않고 모두 넘김
+    auto shared_pending = std::make_shared<const PendingFrames>(std::move(pending));
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        lanes_in_flight_->fetch_add(1, std::memory_order_relaxed);
+        fanout_->executors[i]([lane = lanes_[i], shared_pending, frame, recipients, in_flight = lanes_in_flight_]() {
+            WAGLE_TRACE_SPAN("room.fanout_chunk");
+            for (auto& member : *lane) {
+                // 이 작업을 넣은 뒤 나간 사용자는 건너뜀 (다시 입장했으면 새 입장 정보로 따로 받음)
+                std::lock_guard<std::mutex> member_lock(member->mutex);
+                if (!member->present) {
+                    continue;
+                }
+                User& user = *member->user;
+                shared_pending->deliverTo(user);
+                if (frame && (!recipients || recipients->claim(user.getNameId()))) {
+                    user.deliver(frame);
+                }
+            }
+            in_flight->fetch_sub(1, std::memory_order_release);
+        });
     }
 }
 
-void ChatRoom::broadcastUserCount() {
-    std::unique_lock<std::mutex> lock(chat_room_mutex);
+void ChatRoom::startLanes() {
+    // 사용자는 이름 ID로 실행기를 정하므로 방 인원이 바뀌어도 같은 실행기에서 전송됨
+    size_t lane_count = fanout_->executors.size();
+    std::vector<Lane> initial(lane_count);
+    for (auto& entry : users_) {
+        initial[entry.first->getNameId() % lane_count].push_back(entry.second);
+    }
     
-    // 사용자 수 메시지 생성
-    Message count_msg(MessageType::USER_COUNT, "SERVER", std::to_string(users_.size()));
+    lanes_in_flight_ = std::make_shared<std::atomic<size_t>>(0);
+    for (size_t i = 0; i < lane_count; ++i) {
+        auto lane = std::make_shared<Lane>();
+        lanes_.push_back(lane);
+        fanout_->executors[i]([lane, members = std::move(initial[i])]() mutable {
+            for (size_t slot = 0; slot < members.size(); ++slot) {
+                members[slot]->lane_slot = slot;
+            }
+            *lane = std::move(members);
+        });
+    }
+}
+
+void ChatRoom::addToLane(const std::shared_ptr<Member>& member) {
+    size_t index = member->user->getNameId() % lanes_.size();
+    fanout_->executors[index]([lane = lanes_[index], member]() {
+        member->lane_slot = lane->size();
+        lane->push_back(member);
+    });
+}
+
+void ChatRoom::removeFromLane(const std::shared_ptr<Member>& member) {
+    // 마지막 사용자를 빈자리로 옮겨 상수 시간에 제거
+    size_t index = member->user->getNameId() % lanes_.size();
+    fanout_->executors[index]([lane = lanes_[index], member]() {
+        size_t slot = member->lane_slot;
+        if (slot + 1 != lane->size()) {
+            (*lane)[slot] = std::move(lane->back());
+            (*lane)[slot]->lane_slot = slot;
+        }
+        lane->pop_back();
+    });
+}
+
+bool ChatRoom::closeIfIdle(clock::time_point cutoff) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!users_.empty() || empty_since_ > cutoff) {
+        return false;
+    }
+    closed_ = true;
+    return true;
+}
+
+bool ChatRoom::compactIfIdle(clock::time_point cutoff, const std::string& log_dir) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!users_.empty() || empty_since_ > cutoff || !recent_messages_) {
+        return false;
+    }
+    // 기록을 남긴 뒤 메모리 반환
+    if (!log_dir.empty()) {
+        saveHistoryLocked(log_dir);
+    }
+    recent_messages_.reset();
+    return true;
+}
+
+void ChatRoom::saveHistory(const std::string& log_dir) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    saveHistoryLocked(log_dir);
+}
+
+void ChatRoom::saveHistoryLocked(const std::string& log_dir) const {
+    if (!recent_messages_ || recent_messages_->empty()) {
+        return;
+    }
     
-    // 모든 사용자에게 전송
-    std::string serialized_msg = count_msg.serialize();
-    for (auto& user : users_) {
-        try {
-            boost::asio::write(user->getSocket(), boost::asio::buffer(serialized_msg));
-        } catch (std::exception& e) {
-            std::cerr << "Error broadcasting user count: " << e.what() << std::endl;
+    // 방 이름을 파일 이름으로 쓸 수 있게 경로 구분자 치환
+    std::string file_name = getName();
+    for (auto& c : file_name) {
+        if (c == '/' || c == '\\') {
+            c = '_';
         }
     }
+    if (file_name[0] == '.') {
+        file_name.insert(0, "_");
+    }
+    
+    std::ofstream out(log_dir + "/" + file_name + ".log", std::ios::app);
+    for (const auto& entry : *recent_messages_) {
+        out << *entry.frame;
+    }
 }
 
-} // namespace wagle
\ No newline at end of file
+} // namespace wagle
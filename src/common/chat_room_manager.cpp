@@ -1,32 +1,147 @@
 #include "chat/chat_room_manager.h"
+#include <algorithm>
+#include "protocol/message.h"
+#include "util/metrics.h"
 
 namespace wagle {
 
 const std::string ChatRoomManager::DEFAULT_ROOM_NAME = "General";
 
-ChatRoomManager::ChatRoomManager() {
+ChatRoomManager::ChatRoomManager() : default_room_(names().acquire(DEFAULT_ROOM_NAME)) {
     // 기본 채팅방 생성
-    rooms_[DEFAULT_ROOM_NAME] = std::make_shared<ChatRoom>();
+    createRoom(DEFAULT_ROOM_NAME);
 }
 
 bool ChatRoomManager::createRoom(const std::string& room_name) {
-    std::unique_lock<std::mutex> lock(rooms_mutex_);
+    return addRoom(room_name, true);
+}
+
+bool ChatRoomManager::addRemoteRoom(const std::string& room_name) {
+    return addRoom(room_name, false);
+}
+
+bool ChatRoomManager::isValidRoomName(const std::string& room_name) {
+    return !room_name.empty() && room_name.find_first_of(",;") == std::string::npos;
+}
+
+bool ChatRoomManager::addRoom(const std::string& room_name, bool announce) {
+    // 빈 이름이나 구분자가 든 이름이면 실패
+    if (!isValidRoomName(room_name)) {
+        return false;
+    }
+    
+    // 이름 테이블이 가득 차면 실패 (이미 있는 방이면 등록된 ID를 받고, 실패하면 참조가 바로 해제됨)
+    NameRef name = names().acquire(room_name);
+    if (!name) {
+        return false;
+    }
+    NameId room_id = name.id();
+    Shard& shard = shardFor(room_id);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
-    // 빈 이름이거나 이미 존재하는 방이면 실패
-    if (room_name.empty() || rooms_.find(room_name) != rooms_.end()) {
+    // 이미 존재하는 방이면 실패
+    if (shard.rooms.find(room_id) != shard.rooms.end()) {
         return false;
     }
     
-    // 새 채팅방 생성
-    rooms_[room_name] = std::make_shared<ChatRoom>();
+    shard.rooms.emplace(room_id, std::make_shared<ChatRoom>(name, [this](const NameRef& room_name) {
+        noteRoomChange(room_name, RoomChange::COUNT);
+        if (relay_) {
+            updateInterest(room_name);
+        }
+    }, &fanout_));
+    metrics().rooms.set(++room_count_);
+    lock.unlock();
+    
+    noteRoomChange(name, RoomChange::ADDED);
+    if (announce && relay_) {
+        relay_->announceRoom(room_name);
+    }
     return true;
 }
 
+void ChatRoomManager::setRelay(RoomRelay* relay) {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    relay_ = relay;
+    if (!relay_) {
+        local_rooms_.clear();
+    }
+}
+
+void ChatRoomManager::updateInterest(const NameRef& room_name) {
+    // 마지막으로 호출한 쪽이 최종 사용자 수를 읽으므로 입장/퇴장이 엇갈려도 구독 상태가 맞춰짐
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    if (!relay_) {
+        return;
+    }
+    auto room = getRoom(room_name.id());
+    bool local = room && room->getUserCount() > 0;
+    bool was_local = local_rooms_.count(room_name.id()) > 0;
+    if (local == was_local) {
+        return;
+    }
+    if (local) {
+        local_rooms_.emplace(room_name.id(), room_name);
+    } else {
+        local_rooms_.erase(room_name.id());
+    }
+    relay_->setRoomInterest(room_name.name(), local);
+}
+
+bool ChatRoomManager::isLocalRoom(NameId room_id) const {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    return local_rooms_.count(room_id) > 0;
+}
+
+std::vector<std::string> ChatRoomManager::getLocalRooms() const {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    std::vector<std::string> rooms;
+    rooms.reserve(local_rooms_.size());
+    for (const auto& room : local_rooms_) {
+        rooms.push_back(room.second.name());
+    }
+    return rooms;
+}
+
+void ChatRoomManager::relayChat(const ChatRoom& room, const std::string& sender, const std::string& content) {
+    if (relay_) {
+        relay_->publish(room.getName(), sender, content);
+    }
+}
+
+void ChatRoomManager::deliverRemote(const std::string& room_name, const std::string& sender,
+                                    const std::string& content) {
+    auto room = getRoom(room_name);
+    if (!room || !isLocalRoom(room->getNameId())) {
+        return;
+    }
+    
+    // 순번은 이 노드의 방이 매기므로 재개와 최근 메시지 재전송이 로컬 메시지와 똑같이 동작
+    // 다른 노드의 사용자 이름은 이 노드의 이름 테이블에 등록하지 않음
+    if (room_executor_) {
+        room_executor_(room->getNameId(), [room, sender, content]() {
+            room->broadcast(MessageType::CHAT_MSG, sender, content);
+        });
+    } else {
+        room->broadcast(MessageType::CHAT_MSG, sender, content);
+    }
+}
+
 std::shared_ptr<ChatRoom> ChatRoomManager::getRoom(const std::string& room_name) {
-    std::unique_lock<std::mutex> lock(rooms_mutex_);
+    // 등록되지 않은 이름은 방이 있을 수 없으므로 새로 등록하지 않음
+    NameId room_id = names().find(room_name);
+    if (room_id == EMPTY_NAME_ID) {
+        return nullptr;
+    }
+    return getRoom(room_id);
+}
+
+std::shared_ptr<ChatRoom> ChatRoomManager::getRoom(NameId room_id) {
+    Shard& shard = shardFor(room_id);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
-    auto it = rooms_.find(room_name);
-    if (it != rooms_.end()) {
+    auto it = shard.rooms.find(room_id);
+    if (it != shard.rooms.end()) {
         return it->second;
     }
     
@@ -34,42 +149,228 @@ std::shared_ptr<ChatRoom> ChatRoomManager::getRoom(const std::string& room_name)
 }
 
 std::vector<ChatRoomInfo> ChatRoomManager::getRoomList() const {
-    std::unique_lock<std::mutex> lock(rooms_mutex_);
-    
     std::vector<ChatRoomInfo> room_list;
-    for (const auto& room_pair : rooms_) {
-        bool is_default = (room_pair.first == DEFAULT_ROOM_NAME);
-        room_list.emplace_back(room_pair.first, room_pair.second->getUserCount(), is_default);
+    room_list.reserve(getRoomCount());
+    
+    // 샤드를 하나씩 잠가 다른 샤드의 요청을 막지 않음
+    for (const auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        for (const auto& room_pair : shard.rooms) {
+            bool is_default = (room_pair.first == default_room_.id());
+            room_list.emplace_back(names().name(room_pair.first), room_pair.second->getUserCount(), is_default);
+        }
     }
     
+    std::sort(room_list.begin(), room_list.end(),
+              [](const ChatRoomInfo& a, const ChatRoomInfo& b) { return a.name < b.name; });
     return room_list;
 }
 
+std::string ChatRoomManager::encodeRoomList() const {
+    std::string room_list_data;
+    for (const auto& room_info : getRoomList()) {
+        if (!room_list_data.empty()) {
+            room_list_data += ";";
+        }
+        room_list_data += room_info.name + "," + std::to_string(room_info.user_count) + "," +
+                          (room_info.is_default ? "1" : "0");
+    }
+    return room_list_data;
+}
+
 bool ChatRoomManager::deleteRoom(const std::string& room_name) {
-    std::unique_lock<std::mutex> lock(rooms_mutex_);
+    NameId room_id = names().find(room_name);
     
     // 기본 방은 삭제 불가
-    if (room_name == DEFAULT_ROOM_NAME) {
+    if (room_id == EMPTY_NAME_ID || room_id == default_room_.id()) {
         return false;
     }
     
-    auto it = rooms_.find(room_name);
-    if (it != rooms_.end()) {
+    Shard& shard = shardFor(room_id);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.rooms.find(room_id);
+    if (it != shard.rooms.end()) {
         // 방에 사용자가 있으면 삭제 불가
         if (it->second->getUserCount() > 0) {
             return false;
         }
         
-        rooms_.erase(it);
+        auto room = std::move(it->second);
+        shard.rooms.erase(it);
+        metrics().rooms.set(--room_count_);
+        lock.unlock();
+        
+        noteRoomChange(room->getNameRef(), RoomChange::REMOVED);
+        if (relay_) {
+            relay_->withdrawRoom(room->getName());
+        }
         return true;
     }
     
     return false;
 }
 
+size_t ChatRoomManager::reapIdleRooms(std::chrono::seconds idle, const std::string& log_dir) {
+    auto cutoff = ChatRoom::clock::now() - idle;
+    std::vector<std::shared_ptr<ChatRoom>> reaped;
+    
+    for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        for (auto it = shard.rooms.begin(); it != shard.rooms.end();) {
+            if (it->first != default_room_.id() && it->second->closeIfIdle(cutoff)) {
+                reaped.push_back(std::move(it->second));
+                it = shard.rooms.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    // 파일 기록과 목록 변경 통지는 샤드 락 밖에서 수행
+    for (const auto& room : reaped) {
+        if (!log_dir.empty()) {
+            room->saveHistory(log_dir);
+        }
+        noteRoomChange(room->getNameRef(), RoomChange::REMOVED);
+        if (relay_) {
+            relay_->withdrawRoom(room->getName());
+        }
+    }
+    
+    if (auto default_room = getRoom(default_room_.id())) {
+        default_room->compactIfIdle(cutoff, log_dir);
+    }
+    
+    if (!reaped.empty()) {
+        room_count_ -= reaped.size();
+        metrics().rooms.set(room_count_.load());
+        metrics().rooms_reaped.add(reaped.size());
+    }
+    return reaped.size();
+}
+
+void ChatRoomManager::saveAllHistory(const std::string& log_dir) const {
+    std::vector<std::shared_ptr<ChatRoom>> rooms;
+    rooms.reserve(getRoomCount());
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& room_pair : shard.rooms) {
+            rooms.push_back(room_pair.second);
+        }
+    }
+    
+    // 파일 기록은 샤드 락 밖에서 수행
+    for (const auto& room : rooms) {
+        room->saveHistory(log_dir);
+    }
+}
+
 bool ChatRoomManager::roomExists(const std::string& room_name) const {
-    std::unique_lock<std::mutex> lock(rooms_mutex_);
-    return rooms_.find(room_name) != rooms_.end();
+    NameId room_id = names().find(room_name);
+    if (room_id == EMPTY_NAME_ID) {
+        return false;
+    }
+    
+    const Shard& shard = shardFor(room_id);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    return shard.rooms.find(room_id) != shard.rooms.end();
+}
+
+void ChatRoomManager::noteRoomChange(const NameRef& room_name, RoomChange change) {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    auto it = pending_changes_.find(room_name.id());
+    if (it == pending_changes_.end()) {
+        pending_changes_.emplace(room_name.id(), PendingChange{change, room_name});
+        return;
+    }
+    
+    // 같은 방의 변경은 하나로 합침
+    if (change == RoomChange::REMOVED && it->second.change == RoomChange::ADDED) {
+        // 발행 전에 생겼다 사라진 방은 알릴 필요 없음
+        pending_changes_.erase(it);
+    } else if (change != RoomChange::COUNT) {
+        it->second.change = change;
+    }
+}
+
+void ChatRoomManager::subscribeRoomList(const std::shared_ptr<User>& user) {
+    // 구독 등록과 현재 목록 전송을 한 락 안에서 처리해야 이후 변경분의 버전이 이어짐
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    subscribers_[user->getNameId()] = user;
+    
+    Message snapshot(MessageType::ROOM_LIST, "SERVER", encodeRoomList(), std::to_string(feed_version_));
+    user->deliver(std::make_shared<const std::string>(snapshot.serialize()));
+}
+
+void ChatRoomManager::unsubscribeRoomList(const User* user) {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
+    auto it = subscribers_.find(user->getNameId());
+    if (it != subscribers_.end() && it->second.get() == user) {
+        subscribers_.erase(it);
+    }
+}
+
+void ChatRoomManager::publishRoomUpdates() {
+    std::unordered_map<NameId, PendingChange> changes;
+    std::vector<std::shared_ptr<User>> subscribers;
+    uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(feed_mutex_);
+        if (pending_changes_.empty()) {
+            return;
+        }
+        changes.swap(pending_changes_);
+        
+        // 구독자가 없으면 목록 변경분은 버림 - 새 구독자는 전체 목록부터 받음
+        if (!subscribers_.empty()) {
+            version = ++feed_version_;
+            subscribers.reserve(subscribers_.size());
+            for (const auto& subscriber : subscribers_) {
+                subscribers.push_back(subscriber.second);
+            }
+        }
+    }
+    
+    // 변경분: +이름,사용자 수,기본 방 여부 / -이름 / =이름,사용자 수
+    // 사용자 수는 발행 시점의 값을 읽으므로 그 사이의 여러 변경이 하나로 합쳐짐
+    std::string delta;
+    for (const auto& change : changes) {
+        auto room = (change.second.change == RoomChange::REMOVED) ? nullptr : getRoom(change.first);
+        if (room) {
+            // 방 안의 사용자들에게도 모아 둔 입장/퇴장과 사용자 수를 한 번에 알림
+            if (room_executor_) {
+                room_executor_(change.first, [room]() { room->flushPending(); });
+            } else {
+                room->flushPending();
+            }
+        }
+        if (subscribers.empty()) {
+            continue;
+        }
+        
+        if (!delta.empty()) {
+            delta += ";";
+        }
+        const std::string& name = change.second.room_name.name();
+        if (!room) {
+            delta += "-" + name;
+        } else if (change.second.change == RoomChange::ADDED) {
+            delta += "+" + name + "," + std::to_string(room->getUserCount()) + "," +
+                     (change.first == default_room_.id() ? "1" : "0");
+        } else {
+            delta += "=" + name + "," + std::to_string(room->getUserCount());
+        }
+    }
+    if (subscribers.empty()) {
+        return;
+    }
+    
+    Message update(MessageType::ROOM_LIST_DELTA, "SERVER", delta, std::to_string(version));
+    auto frame = std::make_shared<const std::string>(update.serialize());
+    for (const auto& subscriber : subscribers) {
+        subscriber->deliver(frame);
+    }
 }
 
-} // namespace wagle
\ No newline at end of file
+} // namespace wagle
@@ -0,0 +1,22 @@
+#include "util/handler_allocator.h"
+#include <new>
+
+namespace wagle {
+
+void* HandlerMemory::allocate(std::size_t size) {
+    // 이전 사용자가 해제하며 남긴 내용까지 이 스레드에서 보이도록 acquire
+    if (size <= CAPACITY && !in_use_.exchange(true, std::memory_order_acquire)) {
+        return &storage_;
+    }
+    return ::operator new(size);
+}
+
+void HandlerMemory::deallocate(void* pointer) {
+    if (pointer == &storage_) {
+        in_use_.store(false, std::memory_order_release);
+    } else {
+        ::operator delete(pointer);
+    }
+}
+
+} // namespace wagle
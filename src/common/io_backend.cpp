@@ -0,0 +1,39 @@
+#include "util/io_backend.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define WAGLE_HAVE_IO_URING_HEADER 1
+#endif
+
+namespace wagle {
+
+const char* ioBackendName() {
+#ifdef WAGLE_USE_IO_URING
+    return "io_uring";
+#else
+    return "epoll";
+#endif
+}
+
+bool ioUringAvailable() {
+#if defined(WAGLE_HAVE_IO_URING_HEADER) && defined(__NR_io_uring_setup)
+    io_uring_params params{};
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, 4, &params));
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    
+#ifdef IORING_FEAT_FAST_POLL
+    // fast poll이 없는 커널(5.7 미만)에서는 소켓 작업이 커널 작업 스레드로 넘어가 epoll보다 느림
+    return (params.features & IORING_FEAT_FAST_POLL) != 0;
+#else
+    return false;
+#endif
+#else
+    return false;
+#endif
+}
+
+} // namespace wagle
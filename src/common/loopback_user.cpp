@@ -0,0 +1,16 @@
+#include "chat/loopback_user.h"
+
+namespace wagle {
+
+LoopbackUser::LoopbackUser(NameRef name, Handler on_frame)
+    : User(std::move(name)), on_frame_(std::move(on_frame)) {}
+
+void LoopbackUser::deliver(const Frame& frame) {
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(frame->size(), std::memory_order_relaxed);
+    if (on_frame_) {
+        on_frame_(frame);
+    }
+}
+
+} // namespace wagle
@@ -1,7 +1,7 @@
 #include "protocol/message.h"
 
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <cstdlib>
 
 namespace wagle {
 
@@ -16,83 +16,90 @@ Message::Message(MessageType type, const std::string& sender,
                  const std::string& content, const std::string& room_name)
     : type_(type), sender_(sender), content_(content), room_name_(room_name) {}
 
-std::string Message::serialize() const {
-    std::stringstream ss;
-    std::string safe_sender = sender_;
-    std::string safe_content = content_;
-    std::string safe_room_name = room_name_;
-    // 콜론을 유니코드 대체 문자(˸, UTF-8: \xCB\xB8)로 변경
-    size_t pos = 0;
-    while ((pos = safe_sender.find(':', pos)) != std::string::npos) {
-        safe_sender.replace(pos, 1, "\xCB\xB8");
-        pos += 2;
+// 콜론을 유니코드 대체 문자(˸, UTF-8: \xCB\xB8)로 바꿔 out 끝에 덧붙임
+static void appendField(std::string& out, const std::string& field) {
+    for (char c : field) {
+        if (c == ':') {
+            out += "\xCB\xB8";
+        } else {
+            out += c;
+        }
     }
-    pos = 0;
-    while ((pos = safe_content.find(':', pos)) != std::string::npos) {
-        safe_content.replace(pos, 1, "\xCB\xB8");
-        pos += 2;
+}
+
+// 대체된 콜론 복원
+static void restoreColons(std::string& field) {
+    for (size_t i = 0; i < field.length(); ++i) {
+        if (field[i] == '\xCB' && i+1 < field.length() && field[i+1] == '\xB8') {
+            field.replace(i, 2, ":");
+        }
     }
-    pos = 0;
-    while ((pos = safe_room_name.find(':', pos)) != std::string::npos) {
-        safe_room_name.replace(pos, 1, "\xCB\xB8");
-        pos += 2;
+}
+
+std::string Message::serialize() const {
+    // 메시지마다 호출되므로 스트림 없이 한 번 예약한 버퍼에 이어 붙임
+    std::string out;
+    out.reserve(sender_.size() + content_.size() + room_name_.size() + 32);
+    out += std::to_string(static_cast<int>(type_));
+    out += ':';
+    appendField(out, sender_);
+    out += ':';
+    appendField(out, content_);
+    out += ':';
+    appendField(out, room_name_);
+    if (seq_ != 0) {
+        out += ':';
+        out += std::to_string(seq_);
     }
-    int type_int = static_cast<int>(type_);
-    ss << type_int << ":" << safe_sender << ":" << safe_content << ":" << safe_room_name << "\n";
-    return ss.str();
+    out += '\n';
+    return out;
 }
 
 Message Message::deserialize(const std::string& data) {
-    std::stringstream ss(data);
-    std::string line;
-    if (!std::getline(ss, line)) {
+    // 첫 줄만 해석 (줄을 따로 복사하지 않고 필드만 잘라 냄)
+    size_t line_end = std::min(data.find('\n'), data.size());
+    if (line_end == 0) {
         return Message();
     }
-    size_t first_colon = line.find(':');
-    if (first_colon == std::string::npos) {
+    size_t first_colon = data.find(':');
+    if (first_colon >= line_end) {
         return Message();
     }
-    std::string type_str = line.substr(0, first_colon);
-    int type_int = std::stoi(type_str);
+    int type_int = std::stoi(data.substr(0, first_colon));
     MessageType type = static_cast<MessageType>(type_int);
-    size_t second_colon = line.find(':', first_colon + 1);
-    if (second_colon == std::string::npos) {
-        std::string content = line.substr(first_colon + 1);
-        // 대체된 콜론 복원
-        for (size_t i = 0; i < content.length(); ++i) {
-            if (content[i] == '\xCB' && i+1 < content.length() && content[i+1] == '\xB8') {
-                content.replace(i, 2, ":");
-            }
-        }
+    size_t second_colon = data.find(':', first_colon + 1);
+    if (second_colon >= line_end) {
+        std::string content = data.substr(first_colon + 1, line_end - first_colon - 1);
+        restoreColons(content);
         return Message(type, content);
     }
-    size_t third_colon = line.find(':', second_colon + 1);
-    std::string sender = line.substr(first_colon + 1, second_colon - first_colon - 1);
+    size_t third_colon = data.find(':', second_colon + 1);
+    std::string sender = data.substr(first_colon + 1, second_colon - first_colon - 1);
     std::string content, room_name;
-    if (third_colon == std::string::npos) {
-        content = line.substr(second_colon + 1);
-        room_name = "";
+    uint64_t seq = 0;
+    if (third_colon >= line_end) {
+        content = data.substr(second_colon + 1, line_end - second_colon - 1);
     } else {
-        content = line.substr(second_colon + 1, third_colon - second_colon - 1);
-        room_name = line.substr(third_colon + 1);
-    }
-    // 대체된 콜론 복원
-    for (size_t i = 0; i < sender.length(); ++i) {
-        if (sender[i] == '\xCB' && i+1 < sender.length() && sender[i+1] == '\xB8') {
-            sender.replace(i, 2, ":");
-        }
-    }
-    for (size_t i = 0; i < content.length(); ++i) {
-        if (content[i] == '\xCB' && i+1 < content.length() && content[i+1] == '\xB8') {
-            content.replace(i, 2, ":");
-        }
-    }
-    for (size_t i = 0; i < room_name.length(); ++i) {
-        if (room_name[i] == '\xCB' && i+1 < room_name.length() && room_name[i+1] == '\xB8') {
-            room_name.replace(i, 2, ":");
+        content = data.substr(second_colon + 1, third_colon - second_colon - 1);
+        size_t fourth_colon = data.find(':', third_colon + 1);
+        if (fourth_colon >= line_end) {
+            room_name = data.substr(third_colon + 1, line_end - third_colon - 1);
+        } else {
+            room_name = data.substr(third_colon + 1, fourth_colon - third_colon - 1);
+            seq = std::strtoull(data.c_str() + fourth_colon + 1, nullptr, 10);
         }
     }
-    return Message(type, sender, content, room_name);
+    restoreColons(sender);
+    restoreColons(content);
+    restoreColons(room_name);
+    // 잘라 낸 필드를 복사하지 않고 옮겨 담음
+    Message msg;
+    msg.type_ = type;
+    msg.sender_ = std::move(sender);
+    msg.content_ = std::move(content);
+    msg.room_name_ = std::move(room_name);
+    msg.seq_ = seq;
+    return msg;
 }
 
 std::size_t Message::utf8Length(const std::string& str) {
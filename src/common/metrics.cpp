@@ -0,0 +1,133 @@
+#include "util/metrics.h"
+#include <sys/resource.h>
+
+namespace wagle {
+
+std::size_t metricShardIndex() {
+    // 스레드마다 처음 호출될 때 순서대로 샤드를 배정
+    static std::atomic<std::size_t> next_index{0};
+    thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t Gauge::value() const {
+    int64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.delta.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Histogram::observe(uint64_t value) {
+    // 1us 이하는 0번 구간, 이후 두 배씩 커지는 구간
+    std::size_t bucket = 0;
+    uint64_t bound = 1000;
+    while (bucket < BUCKETS - 1 && value > bound) {
+        bound <<= 1;
+        bucket++;
+    }
+    
+    Shard& shard = shards_[metricShardIndex()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Histogram::render(std::string& out, const char* name, const char* help) const {
+    out += std::string("# HELP ") + name + " " + help + "\n";
+    out += std::string("# TYPE ") + name + " histogram\n";
+    
+    uint64_t cumulative = 0;
+    uint64_t sum = 0;
+    uint64_t count = 0;
+    uint64_t bound = 1000;
+    for (std::size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        for (const auto& shard : shards_) {
+            cumulative += shard.buckets[bucket].load(std::memory_order_relaxed);
+        }
+        std::string le = (bucket == BUCKETS - 1) ? "+Inf" : std::to_string(bound / 1e9);
+        out += std::string(name) + "_bucket{le=\"" + le + "\"} " + std::to_string(cumulative) + "\n";
+        bound <<= 1;
+    }
+    for (const auto& shard : shards_) {
+        sum += shard.sum.load(std::memory_order_relaxed);
+        count += shard.count.load(std::memory_order_relaxed);
+    }
+    out += std::string(name) + "_sum " + std::to_string(sum / 1e9) + "\n";
+    out += std::string(name) + "_count " + std::to_string(count) + "\n";
+}
+
+static void render_value(std::string& out, const char* name, const char* type,
+                         const char* help, const std::string& value) {
+    out += std::string("# HELP ") + name + " " + help + "\n";
+    out += std::string("# TYPE ") + name + " " + type + "\n";
+    out += std::string(name) + " " + value + "\n";
+}
+
+std::string ServerMetrics::render() const {
+    std::string out;
+    render_value(out, "wagle_messages_received_total", "counter", "Messages received from clients",
+                 std::to_string(messages_in.value()));
+    render_value(out, "wagle_messages_sent_total", "counter", "Messages sent to clients",
+                 std::to_string(messages_out.value()));
+    render_value(out, "wagle_received_bytes_total", "counter", "Bytes received from clients",
+                 std::to_string(bytes_in.value()));
+    render_value(out, "wagle_sent_bytes_total", "counter", "Bytes sent to clients",
+                 std::to_string(bytes_out.value()));
+    render_value(out, "wagle_parse_errors_total", "counter", "Messages that could not be parsed",
+                 std::to_string(parse_errors.value()));
+    render_value(out, "wagle_frames_dropped_total", "counter", "Oversized frames discarded",
+                 std::to_string(frames_dropped.value()));
+    render_value(out, "wagle_rate_limited_total", "counter", "Requests rejected by rate limits",
+                 std::to_string(rate_limited.value()));
+    render_value(out, "wagle_session_timeouts_total", "counter", "Connections closed for inactivity",
+                 std::to_string(timeouts.value()));
+    render_value(out, "wagle_slow_consumers_total", "counter", "Connections closed because the outbound queue overflowed",
+                 std::to_string(slow_consumers.value()));
+    render_value(out, "wagle_direct_messages_total", "counter", "Direct messages delivered",
+                 std::to_string(direct_messages.value()));
+    render_value(out, "wagle_rooms_reaped_total", "counter", "Rooms removed after staying empty past the idle timeout",
+                 std::to_string(rooms_reaped.value()));
+    render_value(out, "wagle_session_migrations_total", "counter", "Sessions moved to the core shard that owns their room",
+                 std::to_string(session_migrations.value()));
+    render_value(out, "wagle_core_queue_full_total", "counter", "Requests rejected because a core shard inbox was full",
+                 std::to_string(core_queue_full.value()));
+#ifdef WAGLE_COUNT_ALLOCATIONS
+    render_value(out, "wagle_allocations_total", "counter", "Heap allocations made through operator new",
+                 std::to_string(allocations.value()));
+#endif
+    render_value(out, "wagle_sessions", "gauge", "Open client connections",
+                 std::to_string(sessions.value()));
+    render_value(out, "wagle_rooms", "gauge", "Chat rooms",
+                 std::to_string(rooms.value()));
+    render_value(out, "wagle_outbound_queue_frames", "gauge", "Frames waiting in outbound queues",
+                 std::to_string(outbound_queue.value()));
+    render_value(out, "wagle_interned_names", "gauge", "Room and user names held in the name table",
+                 std::to_string(names.value()));
+    broadcast_time.render(out, "wagle_broadcast_duration_seconds", "Time spent fanning out one room broadcast");
+    
+    // 프로세스 전체 CPU 사용 시간 (사용자 + 커널) - 처리한 메시지 수로 나눠 메시지당 CPU 비용을 비교
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        double cpu_seconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+                             (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        render_value(out, "process_cpu_seconds_total", "counter", "Total user and system CPU time spent in seconds",
+                     std::to_string(cpu_seconds));
+    }
+    return out;
+}
+
+ServerMetrics& metrics() {
+    static ServerMetrics instance;
+    return instance;
+}
+
+} // namespace wagle
@@ -0,0 +1,115 @@
+#include "util/name_table.h"
+#include <functional>
+#include "util/metrics.h"
+
+namespace wagle {
+
+NameTable::NameTable() {
+    // 0번은 빈 이름
+    chunks_[0].store(new Slot[CHUNK_SIZE], std::memory_order_release);
+}
+
+NameTable::~NameTable() {
+    for (auto& chunk : chunks_) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+std::size_t NameTable::shardIndex(const std::string& name) {
+    return std::hash<std::string>()(name) % SHARD_COUNT;
+}
+
+NameRef NameTable::acquire(const std::string& name) {
+    if (name.empty()) {
+        return NameRef();
+    }
+    
+    std::size_t index = shardIndex(name);
+    Shard& shard = shards_[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(name);
+    if (it != shard.ids.end()) {
+        slot(it->second).refs++;
+        return NameRef(it->second);
+    }
+    
+    NameId id = store(name, index);
+    if (id == EMPTY_NAME_ID) {
+        return NameRef();
+    }
+    shard.ids.emplace(name, id);
+    return NameRef(id);
+}
+
+NameId NameTable::find(const std::string& name) const {
+    if (name.empty()) {
+        return EMPTY_NAME_ID;
+    }
+    
+    const Shard& shard = shards_[shardIndex(name)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(name);
+    return (it != shard.ids.end()) ? it->second : EMPTY_NAME_ID;
+}
+
+bool NameTable::full() const {
+    std::lock_guard<std::mutex> lock(store_mutex_);
+    return free_ids_.empty() && (next_id_ >> CHUNK_BITS) >= MAX_CHUNKS;
+}
+
+NameId NameTable::store(const std::string& name, std::size_t shard) {
+    std::lock_guard<std::mutex> lock(store_mutex_);
+    
+    // 해제된 ID가 있으면 재사용 (참조가 없으므로 이전 이름을 읽는 곳이 없음)
+    NameId id;
+    if (!free_ids_.empty()) {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+    } else {
+        std::size_t chunk_index = next_id_ >> CHUNK_BITS;
+        if (chunk_index >= MAX_CHUNKS) {
+            return EMPTY_NAME_ID;
+        }
+        if (!chunks_[chunk_index].load(std::memory_order_relaxed)) {
+            chunks_[chunk_index].store(new Slot[CHUNK_SIZE], std::memory_order_release);
+        }
+        id = next_id_++;
+    }
+    
+    Slot& entry = slot(id);
+    entry.name = name;
+    entry.refs = 1;
+    entry.shard = static_cast<uint8_t>(shard);
+    metrics().names.add();
+    return id;
+}
+
+void NameTable::retain(NameId id) {
+    Slot& entry = slot(id);
+    std::lock_guard<std::mutex> lock(shards_[entry.shard].mutex);
+    entry.refs++;
+}
+
+void NameTable::release(NameId id) {
+    Slot& entry = slot(id);
+    Shard& shard = shards_[entry.shard];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (--entry.refs > 0) {
+            return;
+        }
+        // 샤드 락 안에서 지워야 같은 이름을 찾던 acquire가 지워질 ID를 받지 않음
+        shard.ids.erase(entry.name);
+    }
+    
+    std::lock_guard<std::mutex> lock(store_mutex_);
+    free_ids_.push_back(id);
+    metrics().names.sub();
+}
+
+NameTable& names() {
+    static NameTable instance;
+    return instance;
+}
+
+} // namespace wagle
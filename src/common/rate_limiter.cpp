@@ -0,0 +1,41 @@
+#include "util/rate_limiter.h"
+#include <algorithm>
+#include <chrono>
+
+namespace wagle {
+
+bool TokenBucket::tryConsume(const RateLimit& limit) {
+    uint32_t rate = limit.rate.load(std::memory_order_relaxed);
+    if (rate == 0) {
+        return true;
+    }
+    uint32_t burst = std::max<uint32_t>(limit.burst.load(std::memory_order_relaxed), 1);
+    
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t interval = 1000000000LL / rate;
+    int64_t capacity = interval * burst;
+    
+    int64_t tat = tat_.load(std::memory_order_relaxed);
+    while (true) {
+        int64_t new_tat = std::max(tat, now) + interval;
+        // 버킷이 비어 있으면 거절
+        if (new_tat - now > capacity) {
+            return false;
+        }
+        if (tat_.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+void TokenBucket::refund(const RateLimit& limit) {
+    uint32_t rate = limit.rate.load(std::memory_order_relaxed);
+    if (rate == 0) {
+        return;
+    }
+    // 도착 시각을 한 간격 앞당김 (그 사이 시간이 지나 현재 시각보다 앞서도 다음 소비에서 현재 시각으로 맞춰짐)
+    tat_.fetch_sub(1000000000LL / rate, std::memory_order_relaxed);
+}
+
+} // namespace wagle
@@ -0,0 +1,116 @@
+#include "util/timer_wheel.h"
+
+namespace wagle {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)), start_(clock::now()) {
+    for (auto& level : slots_) {
+        for (auto& head : level) {
+            head.prev = &head;
+            head.next = &head;
+        }
+    }
+}
+
+void TimerWheel::arm(Entry& entry, std::chrono::milliseconds timeout) {
+    if (entry.isArmed()) {
+        unlink(entry);
+    }
+    
+    // 최소 다음 틱에 만료 (올림 처리)
+    uint64_t ticks = (timeout.count() + tick_.count() - 1) / tick_.count();
+    entry.expires = current_tick_ + (ticks > 0 ? ticks : 1);
+    link(entry);
+}
+
+void TimerWheel::cancel(Entry& entry) {
+    if (entry.isArmed()) {
+        unlink(entry);
+    }
+}
+
+void TimerWheel::advance(clock::time_point now) {
+    if (now < start_) {
+        return;
+    }
+    uint64_t target = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_).count() / tick_.count();
+    while (current_tick_ < target) {
+        step();
+    }
+}
+
+void TimerWheel::link(Entry& entry) {
+    // 만료 틱과 현재 틱의 단계별 인덱스 차이가 슬롯 수보다 작은 가장 낮은 단계에 배치
+    int level = 0;
+    while (level < LEVELS - 1 &&
+           (entry.expires >> (level * LEVEL_BITS)) - (current_tick_ >> (level * LEVEL_BITS)) >= SLOTS) {
+        level++;
+    }
+    
+    uint64_t index = entry.expires >> (level * LEVEL_BITS);
+    if (index - (current_tick_ >> (level * LEVEL_BITS)) >= SLOTS) {
+        // 표현 범위를 넘는 타이머는 가장 먼 슬롯에 두고 캐스케이드 때 다시 배치
+        index = (current_tick_ >> (level * LEVEL_BITS)) + SLOTS - 1;
+    }
+    
+    Entry& head = slots_[level][index & (SLOTS - 1)];
+    entry.prev = head.prev;
+    entry.next = &head;
+    head.prev->next = &entry;
+    head.prev = &entry;
+}
+
+void TimerWheel::unlink(Entry& entry) {
+    entry.prev->next = entry.next;
+    entry.next->prev = entry.prev;
+    entry.prev = nullptr;
+    entry.next = nullptr;
+}
+
+void TimerWheel::cascade(int level) {
+    Entry& head = slots_[level][(current_tick_ >> (level * LEVEL_BITS)) & (SLOTS - 1)];
+    
+    // 슬롯의 타이머들을 떼어낸 뒤 낮은 단계로 다시 배치
+    while (head.next != &head) {
+        Entry* entry = head.next;
+        unlink(*entry);
+        link(*entry);
+    }
+}
+
+void TimerWheel::step() {
+    current_tick_++;
+    
+    // 하위 단계가 한 바퀴 돌면 상위 단계 슬롯을 내려보냄 (높은 단계부터)
+    int top = 0;
+    while (top < LEVELS - 1 &&
+           ((current_tick_ >> (top * LEVEL_BITS)) & (SLOTS - 1)) == 0) {
+        top++;
+    }
+    for (int level = top; level > 0; --level) {
+        cascade(level);
+    }
+    
+    // 만료된 타이머를 임시 리스트로 옮긴 뒤 실행 (콜백 안에서 재등록/취소 가능)
+    Entry& head = slots_[0][current_tick_ & (SLOTS - 1)];
+    if (head.next == &head) {
+        return;
+    }
+    Entry expired;
+    expired.next = head.next;
+    expired.prev = head.prev;
+    expired.next->prev = &expired;
+    expired.prev->next = &expired;
+    head.next = &head;
+    head.prev = &head;
+    
+    while (expired.next != &expired) {
+        Entry* entry = expired.next;
+        unlink(*entry);
+        if (entry->callback) {
+            entry->callback();
+        }
+    }
+}
+
+} // namespace wagle
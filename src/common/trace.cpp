@@ -0,0 +1,126 @@
+#include "util/trace.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace wagle {
+namespace trace {
+
+namespace {
+
+// 기록 하나 - 기록하는 스레드가 덮어쓰는 동안 dump()가 읽을 수 있으므로 필드는 모두 원자적 값
+// sequence는 담긴 기록의 번호 + 1이며, 쓰는 동안은 0 (dump는 읽기 전후 값이 같을 때만 사용)
+struct Event {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin{0};
+    std::atomic<uint64_t> end{0};
+};
+
+// 스레드별 링 버퍼 (가득 차면 오래된 기록부터 덮어씀)
+struct ThreadBuffer {
+    static const std::size_t CAPACITY = 1 << 16;
+
+    uint32_t tid;
+    std::atomic<uint64_t> head{0};  // 지금까지 기록된 총 개수
+    Event events[CAPACITY];
+};
+
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;  // 스레드가 종료되어도 기록은 남김
+
+ThreadBuffer* threadBuffer() {
+    thread_local ThreadBuffer* buffer = [] {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffers.back()->tid = static_cast<uint32_t>(buffers.size());
+        return buffers.back().get();
+    }();
+    return buffer;
+}
+
+uint64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 타임스탬프 기준점 (TSC 값을 마이크로초로 환산할 때 사용)
+const uint64_t origin_ticks = now();
+const uint64_t origin_nanos = steadyNanos();
+
+} // namespace
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return steadyNanos();
+#endif
+}
+
+void record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadBuffer* buffer = threadBuffer();
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index % ThreadBuffer::CAPACITY];
+    // 쓰는 중임을 먼저 표시하고 내용을 쓴 뒤 번호를 공개
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.begin.store(begin, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.sequence.store(index + 1, std::memory_order_release);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+bool dump(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    
+    // 지금까지 흐른 시간으로 틱당 마이크로초 계산
+    double ticks = static_cast<double>(now() - origin_ticks);
+    double nanos = static_cast<double>(steadyNanos() - origin_nanos);
+    double us_per_tick = (ticks > 0) ? nanos / ticks / 1000.0 : 0.001;
+    
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (const auto& buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = (head > ThreadBuffer::CAPACITY) ? head - ThreadBuffer::CAPACITY : 0;
+        for (uint64_t i = begin; i < head; ++i) {
+            // 기록하는 스레드가 그 사이 덮어쓰고 있거나 덮어쓴 칸은 건너뜀
+            const Event& event = buffer->events[i % ThreadBuffer::CAPACITY];
+            if (event.sequence.load(std::memory_order_acquire) != i + 1) {
+                continue;
+            }
+            const char* name = event.name.load(std::memory_order_relaxed);
+            uint64_t event_begin = event.begin.load(std::memory_order_relaxed);
+            uint64_t event_end = event.end.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.sequence.load(std::memory_order_relaxed) != i + 1) {
+                continue;
+            }
+            double ts = static_cast<double>(event_begin - origin_ticks) * us_per_tick;
+            double dur = static_cast<double>(event_end - event_begin) * us_per_tick;
+            out << (first ? "" : ",") << "\n{\"name\":\"" << name
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace trace
+} // namespace wagle
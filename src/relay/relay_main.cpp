@@ -0,0 +1,336 @@
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <boost/asio.hpp>
+#include <signal.h>
+#include "protocol/message.h"
+
+using boost::asio::ip::tcp;
+
+// 노드 하나의 송신 대기 메시지 수 제한 (넘으면 느린 노드로 보고 연결을 끊음)
+static const std::size_t MAX_OUTBOUND_FRAMES = 65536;
+
+// 노드에서 받는 한 메시지의 최대 길이
+static const std::size_t MAX_FRAME_BYTES = 65536;
+
+// 시각을 붙여 표준 출력에 기록
+static void log_line(const std::string& text) {
+    time_t now = time(nullptr);
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    char time_str[10];
+    strftime(time_str, sizeof(time_str), "%H:%M:%S", &timeinfo);
+    std::cout << "[" << time_str << "] " << text << std::endl;
+}
+
+class Relay;
+
+// 중계 서버에 연결한 서버 프로세스(노드) 하나
+class RelayNode : public std::enable_shared_from_this<RelayNode> {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    RelayNode(tcp::socket socket, Relay& relay)
+        : socket_(std::move(socket)), relay_(relay), buffer_(MAX_FRAME_BYTES) {}
+
+    void start() { readFrame(); }
+
+    // 송신 큐에 추가 (중계 서버는 한 스레드에서 동작하므로 락 없음)
+    void deliver(const Frame& frame);
+
+    const std::string& name() const { return name_; }
+
+private:
+    void readFrame();
+    void writeQueued();
+
+    tcp::socket socket_;
+    Relay& relay_;
+    boost::asio::streambuf buffer_;
+    std::string name_ = "(unnamed)";
+    std::deque<Frame> write_queue_;
+    bool writing_ = false;
+    bool closed_ = false;
+
+    friend class Relay;
+};
+
+// 방 목록과 노드별 구독을 관리하며 방 메시지를 구독한 다른 노드들에 전달
+class Relay {
+public:
+    Relay(boost::asio::io_context& io_context, const tcp::endpoint& endpoint)
+        : acceptor_(io_context, endpoint) {
+        startAccept();
+    }
+
+    void stop() {
+        boost::system::error_code ignored;
+        acceptor_.close(ignored);
+        for (const auto& node : nodes_) {
+            node->socket_.close(ignored);
+        }
+    }
+
+    // 노드가 보낸 메시지 처리
+    void handle(const std::shared_ptr<RelayNode>& node, const std::string& data) {
+        wagle::Message msg;
+        try {
+            msg = wagle::Message::deserialize(data);
+        } catch (std::exception& e) {
+            return;
+        }
+
+        switch (msg.getType()) {
+            case wagle::MessageType::CONNECT:
+                node->name_ = msg.getSender();
+                log_line("Node connected: " + node->name_);
+                break;
+
+            case wagle::MessageType::ROOM_CREATE: {
+                if (msg.getContent().empty()) {
+                    break;
+                }
+                // 처음 알려진 방만 다른 노드들에 알림 (다시 연결한 노드가 보낸 목록은 대부분 이미 알려짐)
+                auto result = rooms_.emplace(msg.getContent(), std::set<RelayNode*>());
+                if (result.second) {
+                    broadcast(node.get(), std::make_shared<const std::string>(data + "\n"));
+                    for (const auto& other : nodes_) {
+                        result.first->second.insert(other.get());
+                    }
+                } else {
+                    result.first->second.insert(node.get());
+                }
+                break;
+            }
+
+            case wagle::MessageType::ROOM_LIST_DELTA:
+                // 노드가 오래 비어 있던 방을 정리함 ("-방 이름")
+                if (msg.getContent().size() > 1 && msg.getContent()[0] == '-') {
+                    withdraw(node.get(), msg.getContent().substr(1));
+                }
+                break;
+
+            case wagle::MessageType::ROOM_JOIN:
+                subscriptions_[msg.getContent()].insert(node.get());
+                // 방을 정리했던 노드들에 다시 알림 (어느 노드에서든 사용자가 생기면 목록에 다시 보이도록)
+                shareRoom(msg.getContent());
+                break;
+
+            case wagle::MessageType::ROOM_LEAVE:
+                unsubscribe(node.get(), msg.getContent());
+                break;
+
+            case wagle::MessageType::CHAT_MSG: {
+                // 받은 줄을 그대로 구독한 다른 노드들에 전달 (다시 직렬화하지 않음)
+                auto it = subscriptions_.find(msg.getRoomName());
+                if (it == subscriptions_.end()) {
+                    break;
+                }
+                auto frame = std::make_shared<const std::string>(data + "\n");
+                for (RelayNode* subscriber : it->second) {
+                    if (subscriber != node.get()) {
+                        subscriber->deliver(frame);
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    // 노드 연결이 끊김 - 모든 구독에서 제거
+    void remove(const std::shared_ptr<RelayNode>& node) {
+        if (nodes_.erase(node) == 0) {
+            return;
+        }
+        for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+            it->second.erase(node.get());
+            it = it->second.empty() ? subscriptions_.erase(it) : std::next(it);
+        }
+        // 이 노드만 갖고 있던 방은 목록에서 뺌 (다시 연결하면 노드가 방 목록을 다시 보냄)
+        for (auto it = rooms_.begin(); it != rooms_.end();) {
+            it->second.erase(node.get());
+            it = it->second.empty() ? rooms_.erase(it) : std::next(it);
+        }
+        log_line("Node disconnected: " + node->name() + " (" + std::to_string(nodes_.size()) + " nodes)");
+    }
+
+private:
+    void startAccept() {
+        acceptor_.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+            if (!acceptor_.is_open()) {
+                return;
+            }
+            if (!ec) {
+                boost::system::error_code ignored;
+                socket.set_option(tcp::no_delay(true), ignored);
+                auto node = std::make_shared<RelayNode>(std::move(socket), *this);
+                nodes_.insert(node);
+
+                // 새 노드에 지금까지 알려진 방 목록을 보냄
+                for (auto& room : rooms_) {
+                    node->deliver(roomCreateFrame(room.first));
+                    room.second.insert(node.get());
+                }
+                node->start();
+            }
+            startAccept();
+        });
+    }
+
+    void broadcast(const RelayNode* origin, const RelayNode::Frame& frame) {
+        for (const auto& node : nodes_) {
+            if (node.get() != origin) {
+                node->deliver(frame);
+            }
+        }
+    }
+
+    static RelayNode::Frame roomCreateFrame(const std::string& room) {
+        return std::make_shared<const std::string>(
+            wagle::Message(wagle::MessageType::ROOM_CREATE, "RELAY", room).serialize());
+    }
+
+    // 노드가 방을 정리함 - 모든 노드가 정리했으면 목록에서 빼고, 다른 노드에 아직 사용자가 있으면 다시 알림
+    void withdraw(RelayNode* node, const std::string& room) {
+        auto it = rooms_.find(room);
+        if (it == rooms_.end()) {
+            return;
+        }
+        it->second.erase(node);
+        if (it->second.empty()) {
+            rooms_.erase(it);
+            log_line("Room removed: " + room);
+            return;
+        }
+        auto subscribed = subscriptions_.find(room);
+        if (subscribed != subscriptions_.end() &&
+            (subscribed->second.size() > 1 || subscribed->second.count(node) == 0)) {
+            node->deliver(roomCreateFrame(room));
+            it->second.insert(node);
+        }
+    }
+
+    // 방을 갖고 있지 않은 노드들에 방을 알림
+    void shareRoom(const std::string& room) {
+        auto it = rooms_.find(room);
+        if (it == rooms_.end() || it->second.size() == nodes_.size()) {
+            return;
+        }
+        auto frame = roomCreateFrame(room);
+        for (const auto& node : nodes_) {
+            if (it->second.insert(node.get()).second) {
+                node->deliver(frame);
+            }
+        }
+    }
+
+    void unsubscribe(RelayNode* node, const std::string& room) {
+        auto it = subscriptions_.find(room);
+        if (it == subscriptions_.end()) {
+            return;
+        }
+        it->second.erase(node);
+        if (it->second.empty()) {
+            subscriptions_.erase(it);
+        }
+    }
+
+    tcp::acceptor acceptor_;
+    std::set<std::shared_ptr<RelayNode>> nodes_;
+    std::map<std::string, std::set<RelayNode*>> rooms_;                     // 어느 노드에서든 만들어진 방 -> 그 방을 가진 노드
+    std::unordered_map<std::string, std::set<RelayNode*>> subscriptions_;  // 방 이름 -> 사용자가 있는 노드
+};
+
+void RelayNode::deliver(const Frame& frame) {
+    if (closed_) {
+        return;
+    }
+    if (write_queue_.size() >= MAX_OUTBOUND_FRAMES) {
+        // 읽지 못하는 노드 때문에 메모리가 계속 늘지 않도록 끊음 - 노드가 다시 연결하며 구독을 복구함
+        log_line("Slow node disconnected: " + name_);
+        closed_ = true;
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        return;
+    }
+    write_queue_.push_back(frame);
+    if (!writing_) {
+        writeQueued();
+    }
+}
+
+void RelayNode::readFrame() {
+    auto self(shared_from_this());
+    boost::asio::async_read_until(socket_, buffer_, '\n',
+        [this, self](boost::system::error_code ec, std::size_t length) {
+            if (ec) {
+                closed_ = true;
+                relay_.remove(self);
+                return;
+            }
+            std::string data(boost::asio::buffers_begin(buffer_.data()),
+                             boost::asio::buffers_begin(buffer_.data()) + length - 1);
+            buffer_.consume(length);
+            relay_.handle(self, data);
+            readFrame();
+        });
+}
+
+void RelayNode::writeQueued() {
+    writing_ = true;
+    auto self(shared_from_this());
+    boost::asio::async_write(socket_, boost::asio::buffer(*write_queue_.front()),
+        [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+            if (ec) {
+                // 읽기 쪽에서 연결 종료를 처리함
+                writing_ = false;
+                write_queue_.clear();
+                return;
+            }
+            write_queue_.pop_front();
+            if (write_queue_.empty()) {
+                writing_ = false;
+                return;
+            }
+            writeQueued();
+        });
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        // 포트 설정 (기본값 9090)
+        unsigned short port = 9090;
+        if (argc > 1) {
+            port = std::stoi(argv[1]);
+        }
+
+        boost::asio::io_context io_context;
+        Relay relay(io_context, tcp::endpoint(tcp::v4(), port));
+        log_line("Relay listening on port " + std::to_string(port));
+
+        boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([&relay, &io_context](boost::system::error_code ec, int /*signal*/) {
+            if (ec) {
+                return;
+            }
+            relay.stop();
+            io_context.stop();
+        });
+
+        io_context.run();
+    }
+    catch (std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "socket/core_shards.h"
+#include <unistd.h>
+
+namespace wagle {
+
+// 샤드 하나의 받은 작업 큐 길이 (넘치면 보낸 쪽에서 거절)
+static const std::size_t INBOX_CAPACITY = 8192;
+
+// 큐를 한 번 비울 때 처리하는 최대 작업 수 (넘으면 다른 I/O 작업 뒤로 다시 예약)
+static const std::size_t DRAIN_BATCH = 256;
+
+// 지금 스레드가 실행 중인 샤드 번호
+static thread_local int current_shard = -1;
+
+CoreShards::Shard::Shard(std::size_t index, std::chrono::milliseconds wheel_tick)
+    : index(index), inbox(INBOX_CAPACITY), timer_wheel(std::make_shared<TimerWheel>(wheel_tick)),
+      wheel_timer(context) {}
+
+CoreShards::CoreShards(std::size_t count, std::chrono::milliseconds wheel_tick) {
+    for (std::size_t i = 0; i < count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(i, wheel_tick));
+    }
+    for (auto& shard : shards_) {
+        scheduleWheelTick(*shard);
+        Shard* s = shard.get();
+        s->thread = std::thread([s]() {
+            current_shard = static_cast<int>(s->index);
+            // 휠 타이머가 항상 대기 중이므로 stop() 전까지 돌아감
+            s->context.run();
+        });
+    }
+}
+
+CoreShards::~CoreShards() {
+    stop();
+}
+
+int CoreShards::currentIndex() {
+    return current_shard;
+}
+
+bool CoreShards::post(std::size_t index, Task&& task) {
+    Shard& shard = *shards_[index];
+    if (!shard.inbox.tryPush(std::move(task))) {
+        return false;
+    }
+    // 큐를 비우는 작업이 예약되어 있지 않을 때만 io_context를 깨움 (몰려온 작업은 한 번에 처리)
+    if (!shard.drain_scheduled.exchange(true)) {
+        scheduleDrain(shard);
+    }
+    return true;
+}
+
+void CoreShards::scheduleDrain(Shard& shard) {
+    // 다른 스레드에서 예약하면 asio의 스레드별 재사용 메모리가 소비자 스레드 쪽에 쌓이므로 샤드의 메모리를 씀
+    // asio는 핸들러를 호출하기 전에 메모리를 돌려주므로, drain_scheduled를 내린 뒤의 다음 예약과 겹치지 않음
+    Shard* s = &shard;
+    boost::asio::post(shard.context, withAllocator(shard.drain_memory, [this, s]() { drainInbox(*s); }));
+}
+
+void CoreShards::drainInbox(Shard& shard) {
+    // 꺼내기 전에 표시를 내려야 그 사이에 들어온 작업이 새 예약을 만듦
+    shard.drain_scheduled.store(false);
+    Task task;
+    std::size_t processed = 0;
+    while (processed < DRAIN_BATCH && shard.inbox.tryPop(task)) {
+        task();
+        ++processed;
+    }
+    if (processed == DRAIN_BATCH && !shard.drain_scheduled.exchange(true)) {
+        scheduleDrain(shard);
+    }
+}
+
+void CoreShards::scheduleWheelTick(Shard& shard) {
+    shard.wheel_timer.expires_after(shard.timer_wheel->getTick());
+    shard.wheel_timer.async_wait([this, &shard](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+        shard.timer_wheel->advance(TimerWheel::clock::now());
+        scheduleWheelTick(shard);
+    });
+}
+
+void CoreShards::stop() {
+    for (auto& shard : shards_) {
+        shard->context.stop();
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+boost::asio::generic::stream_protocol::socket moveSocket(boost::asio::generic::stream_protocol::socket& socket,
+                                                        boost::asio::io_context& target) {
+    boost::asio::generic::stream_protocol::socket moved(target);
+    boost::system::error_code ec;
+    auto protocol = socket.local_endpoint(ec).protocol();
+    if (ec) {
+        return moved;
+    }
+    auto fd = socket.release(ec);
+    if (ec) {
+        return moved;
+    }
+    moved.assign(protocol, fd, ec);
+    if (ec) {
+        ::close(fd);
+    }
+    return moved;
+}
+
+} // namespace wagle
@@ -0,0 +1,72 @@
+#include "socket/metrics_server.h"
+#include "util/metrics.h"
+
+namespace wagle {
+
+// HTTP 요청 하나를 처리하고 연결을 닫는 세션
+class MetricsConnection : public std::enable_shared_from_this<MetricsConnection> {
+public:
+    using tcp = boost::asio::ip::tcp;
+
+    explicit MetricsConnection(tcp::socket socket)
+        : socket_(std::move(socket)), buffer_(8192) {}
+
+    void start() {
+        auto self(shared_from_this());
+        boost::asio::async_read_until(
+            socket_, buffer_, "\r\n\r\n",
+            [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+                if (ec) {
+                    return;
+                }
+                
+                std::istream is(&buffer_);
+                std::string method, path;
+                is >> method >> path;
+                
+                std::string body;
+                std::string status;
+                if (method == "GET" && (path == "/metrics" || path == "/")) {
+                    status = "200 OK";
+                    body = metrics().render();
+                } else {
+                    status = "404 Not Found";
+                    body = "Not Found\n";
+                }
+                
+                response_ = "HTTP/1.1 " + status + "\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                            "Connection: close\r\n\r\n" + body;
+                boost::asio::async_write(
+                    socket_, boost::asio::buffer(response_),
+                    [this, self](boost::system::error_code /*ec*/, std::size_t /*length*/) {
+                        boost::system::error_code ignored;
+                        socket_.shutdown(tcp::socket::shutdown_both, ignored);
+                    });
+            });
+    }
+
+private:
+    tcp::socket socket_;
+    boost::asio::streambuf buffer_;
+    std::string response_;
+};
+
+MetricsServer::MetricsServer(boost::asio::io_context& io_context, const tcp::endpoint& endpoint)
+    : acceptor_(io_context, endpoint) {
+    startAccept();
+}
+
+void MetricsServer::startAccept() {
+    acceptor_.async_accept(
+        [this](boost::system::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<MetricsConnection>(std::move(socket))->start();
+            }
+            
+            startAccept();
+        });
+}
+
+} // namespace wagle
@@ -0,0 +1,202 @@
+#include "socket/relay_link.h"
+#include <algorithm>
+#include "socket/socket_manager.h"
+
+namespace wagle {
+
+// 재연결 대기 시간 범위 (시도마다 두 배, 그 안에서 무작위)
+static const std::chrono::milliseconds RECONNECT_BASE(500);
+static const std::chrono::milliseconds RECONNECT_CAP(30000);
+
+// 중계 서버로 보낼 대기 메시지 수 제한 (넘으면 버림 - 중계 서버가 느려도 채팅 처리를 막지 않음)
+static const std::size_t MAX_QUEUED_FRAMES = 65536;
+
+// 중계 서버에서 받는 한 메시지의 최대 길이
+static const std::size_t MAX_RELAY_FRAME = 65536;
+
+RelayLink::RelayLink(boost::asio::io_context& io_context, ChatRoomManager& room_manager, std::string host,
+                     std::string port, std::string node_name)
+    : io_context_(io_context), room_manager_(room_manager), host_(std::move(host)), port_(std::move(port)),
+      node_name_(std::move(node_name)), socket_(io_context), resolver_(io_context), reconnect_timer_(io_context),
+      buffer_(MAX_RELAY_FRAME) {}
+
+void RelayLink::start() {
+    add_log_message("Relay: %s:%s as node %s", host_.c_str(), port_.c_str(), node_name_.c_str());
+    connect();
+}
+
+void RelayLink::stop() {
+    stopped_ = true;
+    connected_ = false;
+    reconnect_timer_.cancel();
+    resolver_.cancel();
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+}
+
+void RelayLink::connect() {
+    resolver_.async_resolve(host_, port_, [this](boost::system::error_code ec, tcp::resolver::results_type endpoints) {
+        if (stopped_) {
+            return;
+        }
+        if (ec) {
+            scheduleReconnect();
+            return;
+        }
+        boost::asio::async_connect(socket_, endpoints, [this](boost::system::error_code ec, tcp::endpoint) {
+            if (stopped_) {
+                return;
+            }
+            if (ec) {
+                scheduleReconnect();
+                return;
+            }
+            onConnected();
+        });
+    });
+}
+
+void RelayLink::scheduleReconnect() {
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+
+    // 중계 서버가 재시작되었을 때 노드들이 한꺼번에 몰리지 않도록 대기 시간을 흩뜨림
+    auto limit = std::min<std::chrono::milliseconds::rep>(
+        RECONNECT_CAP.count(), RECONNECT_BASE.count() << std::min(reconnect_attempts_, 16));
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> delay(0, limit);
+    reconnect_attempts_++;
+
+    reconnect_timer_.expires_after(std::chrono::milliseconds(delay(jitter_)));
+    reconnect_timer_.async_wait([this](boost::system::error_code ec) {
+        if (!ec && !stopped_) {
+            connect();
+        }
+    });
+}
+
+void RelayLink::onConnected() {
+    boost::system::error_code ignored;
+    socket_.set_option(tcp::no_delay(true), ignored);
+    add_log_message("Relay connected: %s:%s", host_.c_str(), port_.c_str());
+
+    connected_ = true;
+    generation_++;
+    reconnect_attempts_ = 0;
+    buffer_.consume(buffer_.size());
+    write_queue_.clear();
+
+    // 끊겨 있던 동안의 상태를 처음부터 다시 알림 (중계 서버는 같은 알림을 여러 번 받아도 됨)
+    send(Message(MessageType::CONNECT, node_name_, ""));
+    for (const auto& room_info : room_manager_.getRoomList()) {
+        send(Message(MessageType::ROOM_CREATE, node_name_, room_info.name));
+    }
+    for (const auto& room_name : room_manager_.getLocalRooms()) {
+        send(Message(MessageType::ROOM_JOIN, node_name_, room_name));
+    }
+    readFrame();
+}
+
+void RelayLink::readFrame() {
+    unsigned generation = generation_;
+    boost::asio::async_read_until(socket_, buffer_, '\n',
+        [this, generation](boost::system::error_code ec, std::size_t length) {
+            if (stopped_ || generation != generation_) {
+                return;
+            }
+            if (ec) {
+                add_log_message("Relay disconnected: %s", ec.message().c_str());
+                connected_ = false;
+                writing_ = false;
+                scheduleReconnect();
+                return;
+            }
+
+            std::string data(boost::asio::buffers_begin(buffer_.data()),
+                             boost::asio::buffers_begin(buffer_.data()) + length - 1);
+            buffer_.consume(length);
+            handleFrame(data);
+            readFrame();
+        });
+}
+
+void RelayLink::handleFrame(const std::string& data) {
+    Message msg;
+    try {
+        msg = Message::deserialize(data);
+    } catch (std::exception& e) {
+        return;
+    }
+
+    switch (msg.getType()) {
+        case MessageType::CHAT_MSG:
+            room_manager_.deliverRemote(msg.getRoomName(), msg.getSender(), msg.getContent());
+            break;
+        case MessageType::ROOM_CREATE:
+            if (room_manager_.addRemoteRoom(msg.getContent())) {
+                add_log_message("Remote room added: %s", msg.getContent().c_str());
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void RelayLink::announceRoom(const std::string& room_name) {
+    boost::asio::post(io_context_, [this, room_name]() {
+        send(Message(MessageType::ROOM_CREATE, node_name_, room_name));
+    });
+}
+
+void RelayLink::withdrawRoom(const std::string& room_name) {
+    boost::asio::post(io_context_, [this, room_name]() {
+        send(Message(MessageType::ROOM_LIST_DELTA, node_name_, "-" + room_name));
+    });
+}
+
+void RelayLink::setRoomInterest(const std::string& room_name, bool local) {
+    boost::asio::post(io_context_, [this, room_name, local]() {
+        send(Message(local ? MessageType::ROOM_JOIN : MessageType::ROOM_LEAVE, node_name_, room_name));
+    });
+}
+
+void RelayLink::publish(const std::string& room_name, const std::string& sender, const std::string& content) {
+    boost::asio::post(io_context_, [this, room_name, sender, content]() {
+        send(Message(MessageType::CHAT_MSG, sender, content, room_name));
+    });
+}
+
+void RelayLink::send(const Message& msg) {
+    // 끊겨 있는 동안의 메시지는 버림 (다시 연결하면 구독과 방 목록만 복구)
+    if (!connected_ || write_queue_.size() >= MAX_QUEUED_FRAMES) {
+        return;
+    }
+    write_queue_.push_back(msg.serialize());
+    if (!writing_) {
+        writeQueued();
+    }
+}
+
+void RelayLink::writeQueued() {
+    writing_ = true;
+    unsigned generation = generation_;
+    boost::asio::async_write(socket_, boost::asio::buffer(write_queue_.front()),
+        [this, generation](boost::system::error_code ec, std::size_t /*length*/) {
+            if (stopped_ || generation != generation_) {
+                return;
+            }
+            if (ec) {
+                // 읽기 쪽에서 끊김을 감지해 다시 연결함
+                writing_ = false;
+                socket_.shutdown(tcp::socket::shutdown_both, ec);
+                return;
+            }
+            write_queue_.pop_front();
+            if (write_queue_.empty()) {
+                writing_ = false;
+                return;
+            }
+            writeQueued();
+        });
+}
+
+} // namespace wagle
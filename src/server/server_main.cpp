@@ -1,36 +1,260 @@
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <boost/asio.hpp>
 #include <signal.h>
+#include <unistd.h>
 #include "socket/socket_manager.h"
+#include "socket/metrics_server.h"
+#include "util/trace.h"
+#include "util/io_backend.h"
 
 using boost::asio::ip::tcp;
 
-// Ctrl+C 핸들러
-boost::asio::io_context* global_io_context = nullptr;
+// SIGINT/SIGTERM - 처음에는 연결을 정리하며 종료하고, 정리 중 다시 받으면 바로 종료
+static void wait_shutdown(boost::asio::signal_set& signals, boost::asio::io_context& io_context,
+                          wagle::SocketManager& manager, bool draining) {
+    signals.async_wait([&signals, &io_context, &manager, draining](boost::system::error_code ec, int /*signal*/) {
+        if (ec) {
+            return;
+        }
+        if (draining) {
+            io_context.stop();
+            return;
+        }
+        manager.shutdown([&io_context]() { io_context.stop(); });
+        wait_shutdown(signals, io_context, manager, true);
+    });
+}
+
+#ifdef WAGLE_ENABLE_TRACING
+// SIGUSR1을 받을 때마다 추적 기록을 Chrome trace-event JSON으로 저장
+static void wait_trace_dump(boost::asio::signal_set& signals) {
+    signals.async_wait([&signals](boost::system::error_code ec, int /*signal*/) {
+        if (ec) {
+            return;
+        }
+        std::string path = "wagle_trace_" + std::to_string(getpid()) + ".json";
+        if (wagle::trace::dump(path)) {
+            wagle::add_log_message("Trace written to %s", path.c_str());
+        }
+        wait_trace_dump(signals);
+    });
+}
+#endif
+
+#ifdef WAGLE_USE_IO_URING
+// 이 실행 파일과 같은 디렉터리에 있는 다른 실행 파일의 경로
+static std::string sibling_executable(const std::string& name) {
+    char self[4096];
+    ssize_t length = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (length <= 0) {
+        return name;
+    }
+    std::string path(self, length);
+    return path.substr(0, path.rfind('/') + 1) + name;
+}
+#endif
+
+// "초당/버스트" 형식의 처리율 제한 값 파싱 (예: 10/20)
+static void parse_rate_limit(const std::string& value, uint32_t& rate, uint32_t& burst) {
+    size_t slash = value.find('/');
+    rate = std::stoul(value.substr(0, slash));
+    burst = (slash == std::string::npos) ? rate : std::stoul(value.substr(slash + 1));
+}
+
+static void parse_rate_limit(const std::string& value, wagle::RateLimit& limit) {
+    uint32_t rate = 0;
+    uint32_t burst = 0;
+    parse_rate_limit(value, rate, burst);
+    limit.set(rate, burst);
+}
+
+// 옵션 이름에 해당하는 처리율 제한 (처리율 제한 옵션이 아니면 nullptr)
+static wagle::RateLimit* find_rate_limit(const std::string& name, wagle::RateLimitConfig& limits) {
+    if (name == "chat-limit") {
+        return &limits.session_chat;
+    } else if (name == "room-chat-limit") {
+        return &limits.room_chat;
+    } else if (name == "room-create-limit") {
+        return &limits.room_create;
+    } else if (name == "room-list-limit") {
+        return &limits.room_list;
+    }
+    return nullptr;
+}
+
+// 처리율 제한 파일 읽기 - 한 줄에 "chat-limit=10/20"처럼 옵션과 같은 형식 (#으로 시작하는 줄은 주석)
+// 모든 줄을 해석한 뒤에 한꺼번에 적용하므로 잘못된 줄이 있으면 아무것도 바꾸지 않고 예외를 던짐
+// 한도는 원자적 값이라 실행 중인 세션들이 다음 요청부터 바로 새 한도를 씀
+static void load_rate_limits(const std::string& path, wagle::RateLimitConfig& limits) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    
+    struct Update {
+        wagle::RateLimit* limit;
+        uint32_t rate;
+        uint32_t burst;
+    };
+    std::vector<Update> updates;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t eq = line.find('=');
+        wagle::RateLimit* limit = (eq == std::string::npos) ? nullptr : find_rate_limit(line.substr(0, eq), limits);
+        if (!limit) {
+            throw std::runtime_error("unknown limit: " + line);
+        }
+        Update update{limit, 0, 0};
+        parse_rate_limit(line.substr(eq + 1), update.rate, update.burst);
+        updates.push_back(update);
+    }
+    for (const auto& update : updates) {
+        update.limit->set(update.rate, update.burst);
+    }
+}
 
-void signal_handler(int signal) {
-    if (global_io_context) {
-        global_io_context->stop();
+// SIGHUP을 받을 때마다 처리율 제한 파일을 다시 읽음
+static void wait_reload(boost::asio::signal_set& signals, const std::string& path, wagle::RateLimitConfig& limits) {
+    signals.async_wait([&signals, &path, &limits](boost::system::error_code ec, int /*signal*/) {
+        if (ec) {
+            return;
+        }
+        try {
+            load_rate_limits(path, limits);
+            wagle::add_log_message("Rate limits reloaded from %s", path.c_str());
+        } catch (std::exception& e) {
+            wagle::add_log_message("Rate limit reload failed: %s", e.what());
+        }
+        wait_reload(signals, path, limits);
+    });
+}
+
+// --이름=값 형식의 옵션 처리 (알 수 없는 옵션이면 false)
+static bool parse_option(const std::string& arg, wagle::ServerConfig& config) {
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+        return false;
+    }
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    
+    if (wagle::RateLimit* limit = find_rate_limit(name, config.rate_limits)) {
+        parse_rate_limit(value, *limit);
+    } else if (name == "limits-file") {
+        config.limits_file = value;
+    } else if (name == "max-line") {
+        config.max_line_bytes = std::stoul(value);
+    } else if (name == "max-frame") {
+        config.max_frame_bytes = std::stoul(value);
+    } else if (name == "max-outbound") {
+        config.max_outbound_frames = std::stoul(value);
+    } else if (name == "max-rooms") {
+        config.max_rooms_per_session = std::stoul(value);
+    } else if (name == "heartbeat") {
+        config.heartbeat_interval = std::chrono::seconds(std::stoul(value));
+    } else if (name == "login-timeout") {
+        config.login_timeout = std::chrono::seconds(std::stoul(value));
+    } else if (name == "room-idle-timeout") {
+        config.room_idle_timeout = std::chrono::seconds(std::stoul(value));
+    } else if (name == "room-log-dir") {
+        config.room_log_dir = value;
+    } else if (name == "acceptors") {
+        config.acceptor_threads = std::stoul(value);
+    } else if (name == "backlog") {
+        config.listen_backlog = std::stoi(value);
+    } else if (name == "unix-socket") {
+        config.unix_socket_path = value;
+    } else if (name == "fanout-min-room") {
+        config.fanout_min_room = std::stoul(value);
+    } else if (name == "core-shards") {
+        config.core_shards = std::stoul(value);
+    } else if (name == "relay") {
+        config.relay_address = value;
+    } else if (name == "node-name") {
+        config.node_name = value;
+    } else if (name == "resume-window") {
+        config.resume_window = std::chrono::seconds(std::stoul(value));
+    } else if (name == "shutdown-timeout") {
+        config.shutdown_timeout = std::chrono::seconds(std::stoul(value));
+    } else if (name == "metrics-port") {
+        config.metrics_port = std::stoi(value);
+    } else {
+        return false;
     }
+    return true;
 }
 
 int main(int argc, char* argv[]) {
+#ifdef WAGLE_USE_IO_URING
+    // 커널이 io_uring을 지원하지 않으면 같은 인자로 epoll 빌드를 대신 실행
+    if (!wagle::ioUringAvailable()) {
+        std::string fallback = sibling_executable("wagle_server_epoll");
+        std::cerr << "io_uring is not available, falling back to epoll" << std::endl;
+        execv(fallback.c_str(), argv);
+        std::cerr << "Failed to run " << fallback << std::endl;
+        return 1;
+    }
+#endif
+    
     try {
-        // 포트 설정 (기본값 8080)
+        // 포트 설정 (기본값 8080) 및 옵션 처리
         unsigned short port = 8080;
-        if (argc > 1) {
-            port = std::stoi(argv[1]);
+        wagle::ServerConfig config;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") == 0) {
+                if (!parse_option(arg, config)) {
+                    std::cerr << "Unknown option: " << arg << std::endl;
+                    return 1;
+                }
+            } else {
+                port = std::stoi(arg);
+            }
+        }
+        // 파일의 처리율 제한이 명령줄 옵션보다 우선
+        if (!config.limits_file.empty()) {
+            load_rate_limits(config.limits_file, config.rate_limits);
+        }
+        // 수신 버퍼는 최소 한 줄을 담을 수 있어야 함
+        if (config.max_frame_bytes < config.max_line_bytes) {
+            config.max_frame_bytes = config.max_line_bytes;
         }
         
         // IO 컨텍스트 및 소켓 매니저 생성
         boost::asio::io_context io_context;
-        global_io_context = &io_context;
+        wagle::SocketManager manager(io_context, tcp::endpoint(tcp::v4(), port), config);
+        wagle::add_log_message("I/O backend: %s", wagle::ioBackendName());
+        
+        // 종료 시그널 처리 (시그널 핸들러가 아닌 io_context 스레드에서 실행됨)
+        boost::asio::signal_set shutdown_signals(io_context, SIGINT, SIGTERM);
+        wait_shutdown(shutdown_signals, io_context, manager, false);
         
-        // Ctrl+C 시그널 핸들러 등록
-        signal(SIGINT, signal_handler);
+        // 처리율 제한 다시 읽기 (실행 중인 연결을 끊지 않고 한도만 바꿈)
+        boost::asio::signal_set reload_signals(io_context);
+        if (!config.limits_file.empty()) {
+            reload_signals.add(SIGHUP);
+            wait_reload(reload_signals, config.limits_file, config.rate_limits);
+        }
+        
+        // 지표 엔드포인트 (채팅 포트와 별도)
+        std::unique_ptr<wagle::MetricsServer> metrics_server;
+        if (config.metrics_port != 0) {
+            metrics_server = std::make_unique<wagle::MetricsServer>(
+                io_context, tcp::endpoint(tcp::v4(), config.metrics_port));
+            wagle::add_log_message("Metrics endpoint on port %d", config.metrics_port);
+        }
         
-        // 소켓 매니저 생성
-        wagle::SocketManager manager(io_context, tcp::endpoint(tcp::v4(), port));
+#ifdef WAGLE_ENABLE_TRACING
+        boost::asio::signal_set trace_signals(io_context, SIGUSR1);
+        wait_trace_dump(trace_signals);
+#endif
         
         // 서버 실행
         io_context.run();
@@ -1,10 +1,15 @@
 #include <locale.h>
+#include <unistd.h>
+#include <algorithm>
 #include <mutex>
 #include "socket/socket_manager.h"
 #include "protocol/message.h"
 #include "chat/chat_room_manager.h"
 #include "chat/chat_room.h"
 #include "chat/user.h"
+#include "util/metrics.h"
+#include "util/trace.h"
+#include "util/handler_allocator.h"
 
 namespace wagle {
 
@@ -12,24 +17,38 @@ namespace wagle {
 WINDOW* main_win = nullptr;
 WINDOW* status_win = nullptr;
 WINDOW* log_win = nullptr;
-int total_connections = 0;
-std::set<std::string> active_usernames;
-std::mutex username_mutex;
+std::atomic<int> total_connections{0};
 
-// SessionUser 메서드 구현
-SessionUser::SessionUser(tcp::socket& socket, const std::string& name)
-    : socket_(socket), name_(name) {}
+// 여러 스레드에서 로그/상태 창을 갱신하므로 ncurses 호출을 직렬화
+static std::mutex ui_mutex;
 
-std::string SessionUser::getName() const {
-    return name_;
-}
+// 버퍼 목록을 복사하지 않고 넘기기 위한 참조 (쓰기가 끝날 때까지 목록이 유지되어야 함)
+struct BufferListView {
+    const std::vector<boost::asio::const_buffer>* buffers;
+    
+    std::vector<boost::asio::const_buffer>::const_iterator begin() const { return buffers->begin(); }
+    std::vector<boost::asio::const_buffer>::const_iterator end() const { return buffers->end(); }
+};
 
-SessionUser::tcp::socket& SessionUser::getSocket() {
-    return socket_;
+// 타이밍 휠 한 틱의 길이
+static const std::chrono::milliseconds WHEEL_TICK(100);
+
+// 채팅방 목록과 사용자 수 변경을 모아 보내는 간격
+static const std::chrono::milliseconds ROOM_UPDATE_INTERVAL(250);
+
+// SessionUser 메서드 구현
+SessionUser::SessionUser(std::weak_ptr<Session> session, NameRef name)
+    : User(std::move(name)), session_(std::move(session)) {}
+
+void SessionUser::deliver(const Frame& frame) {
+    if (auto session = session_.lock()) {
+        session->deliver(frame);
+    }
 }
 
 // 서버 UI 함수들
 void init_server_ui() {
+    std::lock_guard<std::mutex> lock(ui_mutex);
     setlocale(LC_ALL, "");
     if (stdscr) {
         if (status_win) delwin(status_win);
@@ -66,6 +85,7 @@ void init_server_ui() {
 }
 
 void cleanup_server_ui() {
+    std::lock_guard<std::mutex> lock(ui_mutex);
     if (status_win) delwin(status_win);
     if (log_win) delwin(log_win);
     if (main_win) delwin(main_win);
@@ -77,6 +97,7 @@ void cleanup_server_ui() {
 }
 
 void update_status_window(size_t user_count, const std::vector<wagle::ChatRoomInfo>& room_list) {
+    std::lock_guard<std::mutex> lock(ui_mutex);
     if (!status_win) return;
     werase(status_win);
     box(status_win, 0, 0);
@@ -96,15 +117,17 @@ void update_status_window(size_t user_count, const std::vector<wagle::ChatRoomIn
 }
 
 void add_log_message(const char* format, ...) {
+    std::lock_guard<std::mutex> lock(ui_mutex);
     if (!log_win) return;
     
     va_list args;
     va_start(args, format);
     
     time_t now = time(nullptr);
-    struct tm* timeinfo = localtime(&now);
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
     char time_str[10];
-    strftime(time_str, sizeof(time_str), "%H:%M:%S", timeinfo);
+    strftime(time_str, sizeof(time_str), "%H:%M:%S", &timeinfo);
     
     wprintw(log_win, "[%s] ", time_str);
     vw_printw(log_win, format, args);
@@ -115,199 +138,634 @@ void add_log_message(const char* format, ...) {
 }
 
 // Session 클래스 구현
-Session::Session(tcp::socket socket, ChatRoomManager& room_manager)
-    : socket_(std::move(socket)), room_manager_(room_manager) {
+Session::Session(Socket socket, std::string client_address, ChatRoomManager& room_manager,
+                 UserRegistry& user_registry, const ServerConfig& config, std::shared_ptr<TimerWheel> timer_wheel,
+                 CoreShards* core_shards, int shard)
+    : socket_(std::move(socket)), room_manager_(room_manager), user_registry_(user_registry), config_(config),
+      buffer_(config.max_frame_bytes), client_address_(std::move(client_address)),
+      timer_wheel_(std::move(timer_wheel)), core_shards_(core_shards), shard_(shard) {
     total_connections++;
+    metrics().sessions.add();
+    liveness_timer_.callback = [this]() { onLivenessTimeout(); };
+}
+
+Session::~Session() {
+    timer_wheel_->cancel(liveness_timer_);
+    metrics().sessions.sub();
 }
 
 void Session::start() {
-    try {
-        client_address_ = socket_.remote_endpoint().address().to_string();
-        add_log_message("New connection from %s", client_address_.c_str());
-    } catch (std::exception& e) {
-        client_address_ = "unknown";
-        add_log_message("New connection from unknown address");
-    }
+    add_log_message("New connection from %s", client_address_.c_str());
     
+    // 로그인 기한은 수락 시각부터 정해지며 로그인 전의 수신으로는 미뤄지지 않음
+    if (config_.login_timeout.count() > 0) {
+        timer_wheel_->arm(liveness_timer_, config_.login_timeout);
+    }
+#ifdef WAGLE_USE_COROUTINES
+    boost::asio::co_spawn(socket_.get_executor(), run(shared_from_this()), boost::asio::detached);
+#else
     readUsername();
+#endif
 }
 
+#ifdef WAGLE_USE_COROUTINES
+boost::asio::awaitable<void> Session::run([[maybe_unused]] std::shared_ptr<Session> self) {
+    // 읽기 -> 파싱 -> 처리를 한 루프에서 (코루틴 프레임은 스레드별로 재사용됨)
+    for (;;) {
+        boost::system::error_code ec;
+        std::size_t length = co_await boost::asio::async_read_until(
+            socket_, buffer_, '\n', boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        
+        WAGLE_TRACE_SPAN("session.handle_frame");
+        if (ec == boost::asio::error::not_found) {
+            discardOversizedFrame();
+            continue;
+        }
+        if (ec) {
+            break;
+        }
+        
+        Message msg;
+        if (!extractFrame(length, line_) || !parseFrame(line_, msg)) {
+            continue;
+        }
+        
+        if (!logged_in_) {
+            if (msg.getType() == MessageType::CONNECT) {
+                handleLogin(msg);
+            }
+        } else if (!draining_) {
+            dispatch(msg);
+        }
+        if (migrate_to_ >= 0) {
+            // 새 샤드에서 코루틴을 다시 시작함
+            beginMigration();
+            co_return;
+        }
+    }
+    
+    if (logged_in_) {
+        onDisconnected();
+    }
+}
+#else
 void Session::readUsername() {
     auto self(shared_from_this());
     boost::asio::async_read_until(
         socket_, buffer_, '\n',
-        [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+        withAllocator(read_memory_, [this, self](boost::system::error_code ec, std::size_t length) {
+            if (ec == boost::asio::error::not_found) {
+                discardOversizedFrame();
+                readUsername();
+                return;
+            }
             if (!ec) {
-                std::string data;
-                std::istream is(&buffer_);
-                std::getline(is, data);
-                
-                Message msg = Message::deserialize(data);
-                if (msg.getType() == MessageType::CONNECT) {
-                    username_ = msg.getSender();
-                    
-                    bool isValid = true;
-                    std::string errorMsg;
-                    
-                    if (username_.empty()) {
-                        isValid = false;
-                        errorMsg = "Username cannot be empty";
-                    } else {
-                        std::unique_lock<std::mutex> lock(username_mutex);
-                        if (active_usernames.find(username_) != active_usernames.end()) {
-                            isValid = false;
-                            errorMsg = "Username already in use";
-                        } else {
-                            active_usernames.insert(username_);
-                        }
-                    }
-                    
-                    if (!isValid) {
-                        Message error_msg(MessageType::DISCONNECT, "SERVER", errorMsg);
-                        boost::asio::write(socket_, boost::asio::buffer(error_msg.serialize()));
-                        add_log_message("Username validation failed: %s (%s)", 
-                                      username_.c_str(), errorMsg.c_str());
-                        readUsername();
-                        return;
-                    }
-                    
-                    add_log_message("User connected: %s (%s)", username_.c_str(), client_address_.c_str());
-                    
-                    Message confirm_msg(MessageType::CONNECT, "SERVER", "Connection successful");
-                    boost::asio::write(socket_, boost::asio::buffer(confirm_msg.serialize()));
-                    
-                    readMessage();
+                Message msg;
+                if (!extractFrame(length, line_) || !parseFrame(line_, msg) ||
+                    msg.getType() != MessageType::CONNECT || !handleLogin(msg)) {
+                    readUsername();
+                    return;
                 }
+                readMessage();
             }
-        });
+        }));
 }
 
 void Session::readMessage() {
     auto self(shared_from_this());
     boost::asio::async_read_until(
         socket_, buffer_, '\n',
-        [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+        withAllocator(read_memory_, [this, self](boost::system::error_code ec, std::size_t length) {
+            WAGLE_TRACE_SPAN("session.handle_frame");
+            if (ec == boost::asio::error::not_found) {
+                discardOversizedFrame();
+                readMessage();
+                return;
+            }
             if (!ec) {
-                std::string data;
-                std::istream is(&buffer_);
-                std::getline(is, data);
-                
-                Message msg = Message::deserialize(data);
-                
-                switch (msg.getType()) {
-                    case MessageType::ROOM_LIST:
-                        handleRoomListRequest();
-                        break;
-                        
-                    case MessageType::ROOM_CREATE:
-                        handleRoomCreateRequest(msg.getContent());
-                        break;
-                        
-                    case MessageType::ROOM_JOIN:
-                        handleRoomJoinRequest(msg.getContent());
-                        break;
-                        
-                    case MessageType::ROOM_LEAVE:
-                        handleRoomLeaveRequest();
-                        break;
-                        
-                    case MessageType::CHAT_MSG:
-                        if (!current_room_.empty()) {
-                            auto room = room_manager_.getRoom(current_room_);
-                            if (room) {
-                                Message broadcast_msg(MessageType::CHAT_MSG, username_, msg.getContent(), current_room_);
-                                room->broadcast(broadcast_msg);
-                            }
-                        }
-                        break;
-                        
-                    default:
-                        break;
+                Message msg;
+                if (extractFrame(length, line_) && parseFrame(line_, msg) && !draining_) {
+                    dispatch(msg);
+                }
+                if (migrate_to_ >= 0) {
+                    beginMigration();
+                    return;
                 }
-                
                 readMessage();
             } else {
-                add_log_message("User disconnected: %s (%s)", username_.c_str(), client_address_.c_str());
-                {
-                    std::unique_lock<std::mutex> lock(username_mutex);
-                    active_usernames.erase(username_);
+                onDisconnected();
+            }
+        }));
+}
+#endif
+
+void Session::resumeReading() {
+#ifdef WAGLE_USE_COROUTINES
+    boost::asio::co_spawn(socket_.get_executor(), run(shared_from_this()), boost::asio::detached);
+#else
+    readMessage();
+#endif
+}
+
+boost::asio::io_context::executor_type Session::sessionExecutor() {
+    return *socket_.get_executor().target<boost::asio::io_context::executor_type>();
+}
+
+void Session::postToSession(std::function<void()> task) {
+    auto self(shared_from_this());
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    boost::asio::post(sessionExecutor(), withAllocator(task_memory_, [this, self, task]() {
+        // 샤드를 옮기기 전에 예전 스레드로 보낸 작업은 새 스레드로 다시 보냄
+        if (core_shards_ && shard_ != CoreShards::currentIndex()) {
+            postToSession(task);
+            return;
+        }
+        task();
+    }));
+}
+
+void Session::beginMigration() {
+    // 옛 샤드의 휠에 등록된 타이머는 옛 스레드에서 취소하고 새 샤드에서 다시 등록
+    timer_wheel_->cancel(liveness_timer_);
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        migrating_ = true;
+        if (write_in_progress_) {
+            // 쓰기 완료 핸들러가 이어서 옮김
+            return;
+        }
+    }
+    completeMigration();
+}
+
+void Session::completeMigration() {
+    // 이 세션의 비동기 작업이 하나도 대기 중이지 않은 상태
+    size_t target = static_cast<size_t>(migrate_to_);
+    migrate_to_ = -1;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        socket_ = moveSocket(socket_, core_shards_->context(target));
+        shard_ = static_cast<int>(target);
+    }
+    timer_wheel_ = core_shards_->timerWheel(target);
+    metrics().session_migrations.add();
+    
+    auto self(shared_from_this());
+    boost::asio::post(socket_.get_executor(), [this, self]() { finishMigration(); });
+}
+
+void Session::finishMigration() {
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        migrating_ = false;
+        if (write_stopped_) {
+            // 옮기는 동안 송신 큐가 넘침
+            boost::system::error_code ignored;
+            socket_.shutdown(Socket::shutdown_both, ignored);
+            socket_.close(ignored);
+        } else if (!write_queue_.empty()) {
+            write_in_progress_ = true;
+            auto self(shared_from_this());
+            boost::asio::post(sessionExecutor(), withAllocator(write_memory_, [this, self]() { writeQueued(); }));
+        } else if (close_after_flush_) {
+            boost::system::error_code ignored;
+            socket_.shutdown(Socket::shutdown_send, ignored);
+        }
+    }
+    // 옮기는 동안 연결을 끊기 시작했으면 이미 해제한 기한을 새 샤드에 다시 걸지 않음
+    if (!draining_) {
+        touchLiveness();
+    }
+    
+    if (after_migration_) {
+        auto task = std::move(after_migration_);
+        after_migration_ = nullptr;
+        if (!draining_) {
+            task();
+        }
+    }
+    resumeReading();
+}
+
+bool Session::handleLogin(const Message& msg) {
+    std::string username = msg.getSender();
+    NameRef user_name;
+    
+    bool isValid = true;
+    std::string errorMsg;
+    
+    bool resumed = false;
+    if (username.empty()) {
+        isValid = false;
+        errorMsg = "Username cannot be empty";
+    } else if (!(user_name = names().acquire(username))) {
+        // 이름 테이블이 가득 참 - 로그인에 실패한 이름은 참조가 남지 않으므로 곧 다시 쓸 수 있게 됨
+        isValid = false;
+        errorMsg = "Server is full, please try again later";
+    } else {
+        NameId user_id = user_name.id();
+        // 재개 토큰이 있으면 이전 연결의 이름을 넘겨받음 (끊긴 것을 아직 모르는 이전 세션은 종료)
+        std::shared_ptr<Session> previous;
+        if (!msg.getContent().empty() &&
+            user_registry_.resume(user_id, msg.getContent(), shared_from_this(), previous)) {
+            resumed = true;
+            if (previous) {
+                previous->disconnect("Session resumed from another connection");
+            }
+        } else if (!user_registry_.claim(user_id, shared_from_this())) {
+            isValid = false;
+            errorMsg = "Username already in use";
+        }
+    }
+    
+    if (!isValid) {
+        Message error_msg(MessageType::DISCONNECT, "SERVER", errorMsg);
+        send(error_msg);
+        add_log_message("Username validation failed: %s (%s)", 
+                      username.c_str(), errorMsg.c_str());
+        return false;
+    }
+    
+    user_name_ = std::move(user_name);
+    user_ = std::make_shared<SessionUser>(shared_from_this(), user_name_);
+    add_log_message("User %s: %s (%s)", resumed ? "resumed" : "connected", username.c_str(), client_address_.c_str());
+    
+    // 다음 재접속 때 쓸 재개 토큰은 room_name 필드로 전달
+    Message confirm_msg(MessageType::CONNECT, "SERVER", resumed ? "Session resumed" : "Connection successful",
+                        user_registry_.issueResumeToken(user_name_, shared_from_this()));
+    send(confirm_msg);
+    
+    logged_in_ = true;
+    touchLiveness();
+    return true;
+}
+
+void Session::dispatch(const Message& msg) {
+    switch (msg.getType()) {
+        case MessageType::ROOM_LIST:
+            if (room_list_bucket_.tryConsume(config_.rate_limits.room_list)) {
+                handleRoomListRequest();
+            } else {
+                sendRateLimitError();
+            }
+            break;
+            
+        case MessageType::ROOM_SUBSCRIBE:
+            if (room_list_bucket_.tryConsume(config_.rate_limits.room_list)) {
+                handleRoomSubscribe(msg.getContent());
+            } else {
+                sendRateLimitError();
+            }
+            break;
+            
+        case MessageType::ROOM_CREATE:
+            if (room_create_bucket_.tryConsume(config_.rate_limits.room_create)) {
+                handleRoomCreateRequest(msg.getContent());
+            } else {
+                sendRateLimitError();
+            }
+            break;
+            
+        case MessageType::ROOM_JOIN:
+            handleRoomJoinRequest(msg.getContent(), msg.getSeq(), false);
+            break;
+            
+        case MessageType::ROOM_JOIN_KEEP:
+            handleRoomJoinRequest(msg.getContent(), msg.getSeq(), true);
+            break;
+            
+        case MessageType::ROOM_LEAVE:
+            handleRoomLeaveRequest(msg.getContent());
+            break;
+            
+        case MessageType::CHAT_MSG:
+            handleChatMessage(msg);
+            break;
+            
+        case MessageType::DIRECT_MSG:
+            handleDirectMessage(msg);
+            break;
+            
+        case MessageType::PING: {
+            Message pong(MessageType::PONG, "SERVER", "");
+            send(pong);
+            break;
+        }
+            
+        default:
+            break;
+    }
+}
+
+void Session::onDisconnected() {
+    timer_wheel_->cancel(liveness_timer_);
+    add_log_message("User disconnected: %s (%s)", username().c_str(), client_address_.c_str());
+    user_registry_.release(user_name_.id(), this);
+    if (user_) {
+        room_manager_.unsubscribeRoomList(user_.get());
+    }
+    leaveAllRooms();
+    
+    auto room_list = room_manager_.getRoomList();
+    size_t total_users = 0;
+    for (const auto& room_info : room_list) {
+        total_users += room_info.user_count;
+    }
+    update_status_window(total_users, room_list);
+}
+
+bool Session::extractFrame(std::size_t length, std::string& data) {
+    // 버리는 중이던 프레임의 끝 또는 줄 길이 제한을 넘은 프레임은 복사 없이 버림
+    if (discarding_ || length > config_.max_line_bytes) {
+        buffer_.consume(length);
+        discarding_ = false;
+        metrics().frames_dropped.add();
+        add_log_message("Oversized frame dropped from %s", client_address_.c_str());
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Message too large");
+        send(response);
+        return false;
+    }
+    
+    std::istream is(&buffer_);
+    std::getline(is, data);
+    metrics().messages_in.add();
+    metrics().bytes_in.add(length);
+    touchLiveness();
+    return true;
+}
+
+bool Session::parseFrame(const std::string& data, Message& msg) {
+    WAGLE_TRACE_SPAN("message.deserialize");
+    try {
+        msg = Message::deserialize(data);
+    } catch (std::exception& e) {
+        metrics().parse_errors.add();
+        return false;
+    }
+    
+    if (msg.getType() < MessageType::CONNECT || msg.getType() > LAST_MESSAGE_TYPE) {
+        metrics().parse_errors.add();
+        return false;
+    }
+    return true;
+}
+
+void Session::send(const Message& msg) {
+    deliver(std::make_shared<const std::string>(msg.serialize()));
+}
+
+void Session::deliver(const User::Frame& frame) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (write_stopped_ || close_after_flush_) {
+        return;
+    }
+    
+    // 읽지 않는 연결 때문에 메모리가 계속 늘지 않도록 큐가 넘치면 연결을 끊음
+    if (write_queue_.size() >= config_.max_outbound_frames) {
+        write_stopped_ = true;
+        metrics().slow_consumers.add();
+        if (migrating_) {
+            // 옮긴 뒤 새 스레드에서 닫음
+            return;
+        }
+        auto self(shared_from_this());
+        boost::asio::post(socket_.get_executor(), [this, self]() {
+            if (core_shards_ && shard_ != CoreShards::currentIndex()) {
+                return;  // 그 사이 샤드를 옮김 - 새 스레드에서 이미 닫음
+            }
+            add_log_message("Slow consumer disconnected: %s (%s)", username().c_str(), client_address_.c_str());
+            boost::system::error_code ignored;
+            socket_.shutdown(Socket::shutdown_both, ignored);
+            socket_.close(ignored);
+        });
+        return;
+    }
+    
+    write_queue_.push_back(frame);
+    metrics().outbound_queue.add();
+    if (!write_in_progress_ && !migrating_) {
+        // 쓰기가 진행 중이 아니므로 쓰기용 핸들러 메모리는 비어 있음
+        write_in_progress_ = true;
+        auto self(shared_from_this());
+        boost::asio::post(sessionExecutor(), withAllocator(write_memory_, [this, self]() { writeQueued(); }));
+    }
+}
+
+void Session::writeQueued() {
+    {
+        // 비워 둔 writing_과 맞바꿔 두 벡터의 용량을 번갈아 재사용
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        writing_.swap(write_queue_);
+    }
+    write_buffers_.clear();
+    for (const auto& frame : writing_) {
+        write_buffers_.push_back(boost::asio::buffer(*frame));
+    }
+    
+    // 대기 중인 메시지를 한 번의 gather write로 전송 (버퍼 목록은 복사하지 않고 멤버를 참조)
+    auto self(shared_from_this());
+    boost::asio::async_write(
+        socket_, BufferListView{&write_buffers_},
+        withAllocator(write_memory_, [this, self](boost::system::error_code ec, std::size_t length) {
+            WAGLE_TRACE_SPAN("session.write_complete");
+            metrics().outbound_queue.sub(writing_.size());
+            if (!ec) {
+                metrics().messages_out.add(writing_.size());
+                metrics().bytes_out.add(length);
+            }
+            writing_.clear();
+            
+            bool migrate = false;
+            {
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                if (ec) {
+                    // 오류 시 남은 메시지는 버림 - 읽기 쪽에서 연결 종료를 처리함
+                    metrics().outbound_queue.sub(write_queue_.size());
+                    write_queue_.clear();
+                    write_stopped_ = true;
                 }
-                if (!current_room_.empty()) {
-                    auto room = room_manager_.getRoom(current_room_);
-                    if (room && user_) {
-                        auto user_ptr = std::make_shared<User>(user_->getSocket(), user_->getName());
-                        room->leave(user_ptr);
+                if (migrating_) {
+                    // 남은 메시지는 옮긴 뒤 새 스레드에서 보냄
+                    write_in_progress_ = false;
+                    migrate = true;
+                } else if (write_queue_.empty()) {
+                    write_in_progress_ = false;
+                    if (close_after_flush_) {
+                        // 종료 알림까지 모두 보냄 - 송신 쪽만 닫고 상대가 닫으면 읽기 쪽에서 정리됨
+                        boost::system::error_code ignored;
+                        socket_.shutdown(Socket::shutdown_send, ignored);
                     }
+                    return;
                 }
-                
-                auto room_list = room_manager_.getRoomList();
-                size_t total_users = 0;
-                for (const auto& room_info : room_list) {
-                    total_users += room_info.user_count;
-                }
-                update_status_window(total_users, room_list);
             }
-        });
+            if (migrate) {
+                completeMigration();
+                return;
+            }
+            writeQueued();
+        }));
 }
 
-void Session::handleRoomListRequest() {
-    auto room_list = room_manager_.getRoomList();
-    
-    std::string room_list_data;
-    for (const auto& room_info : room_list) {
-        if (!room_list_data.empty()) {
-            room_list_data += ";";
+void Session::disconnect(const std::string& reason) {
+    auto self(shared_from_this());
+    postToSession([this, self, reason]() {
+        if (draining_) {
+            return;
+        }
+        draining_ = true;
+        timer_wheel_->cancel(liveness_timer_);
+        
+        send(Message(MessageType::DISCONNECT, "SERVER", reason));
+        
+        // 연결이 실제로 닫힐 때까지 기다리지 않고 방에서 나감 (같은 이름으로 재개한 세션과 겹치지 않도록)
+        leaveAllRooms();
+        
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        close_after_flush_ = true;
+        if (!write_in_progress_ && !migrating_) {
+            // 보낼 것이 없거나 쓰기가 이미 멈춤
+            boost::system::error_code ignored;
+            socket_.shutdown(Socket::shutdown_send, ignored);
         }
-        room_list_data += room_info.name + "," + std::to_string(room_info.user_count) + "," + 
-                         (room_info.is_default ? "1" : "0");
+    });
+}
+
+void Session::discardOversizedFrame() {
+    // 구분자 없이 버퍼가 가득 참 - 지금까지 받은 내용을 버리고 줄 끝까지 계속 버림
+    buffer_.consume(buffer_.size());
+    discarding_ = true;
+}
+
+void Session::touchLiveness() {
+    // 로그인 전에는 아무 줄이나 보내며 연결을 유지하지 못하도록 기한을 미루지 않음
+    if (!logged_in_) {
+        return;
     }
     
-    Message response(MessageType::ROOM_LIST, "SERVER", room_list_data);
-    boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
+    // 수신이 있을 때마다 만료 시각을 미룸 (O(1))
+    ping_outstanding_ = false;
+    if (config_.heartbeat_interval.count() > 0) {
+        timer_wheel_->arm(liveness_timer_, config_.heartbeat_interval);
+    } else {
+        timer_wheel_->cancel(liveness_timer_);  // 로그인 기한 해제
+    }
+}
+
+void Session::onLivenessTimeout() {
+    // 로그인 전이거나 PING에 응답이 없으면 연결을 끊음 - 대기 중인 읽기가 실패하며 정리됨
+    if (!logged_in_ || ping_outstanding_) {
+        metrics().timeouts.add();
+        add_log_message("Connection timed out: %s (%s)", username().c_str(), client_address_.c_str());
+        boost::system::error_code ignored;
+        socket_.shutdown(Socket::shutdown_both, ignored);
+        socket_.close(ignored);
+        return;
+    }
+    
+    ping_outstanding_ = true;
+    Message ping(MessageType::PING, "SERVER", "");
+    send(ping);
+    timer_wheel_->arm(liveness_timer_, config_.heartbeat_interval);
+}
+
+void Session::handleRoomListRequest() {
+    Message response(MessageType::ROOM_LIST, "SERVER", room_manager_.encodeRoomList());
+    send(response);
+}
+
+void Session::handleRoomSubscribe(const std::string& content) {
+    if (content == "0") {
+        room_manager_.unsubscribeRoomList(user_.get());
+    } else {
+        room_manager_.subscribeRoomList(user_);
+    }
 }
 
 void Session::handleRoomCreateRequest(const std::string& room_name) {
-    if (room_manager_.createRoom(room_name)) {
+    if (!room_name.empty() && !ChatRoomManager::isValidRoomName(room_name)) {
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Room name cannot contain ',' or ';'", room_name);
+        send(response);
+    } else if (room_manager_.createRoom(room_name)) {
         Message response(MessageType::ROOM_CREATE, "SERVER", "Room created successfully");
-        boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
-        add_log_message("Room created: %s by %s", room_name.c_str(), username_.c_str());
+        send(response);
+        add_log_message("Room created: %s by %s", room_name.c_str(), username().c_str());
+    } else if (names().full()) {
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Server is full, please try again later");
+        send(response);
     } else {
         Message response(MessageType::ROOM_ERROR, "SERVER", "Failed to create room (name already exists or invalid)");
-        boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
+        send(response);
     }
 }
 
-void Session::handleRoomJoinRequest(const std::string& room_name) {
+std::shared_ptr<ChatRoom> Session::findJoinedRoom(const std::string& room_name) const {
+    for (const auto& room : rooms_) {
+        if (room->getName() == room_name) {
+            return room;
+        }
+    }
+    return nullptr;
+}
+
+void Session::leaveRoom(const std::shared_ptr<ChatRoom>& room) {
+    room->leave(user_);
+    rooms_.erase(std::find(rooms_.begin(), rooms_.end(), room));
+}
+
+void Session::leaveAllRooms() {
+    if (user_) {
+        for (const auto& room : rooms_) {
+            room->leave(user_);
+        }
+    }
+    rooms_.clear();
+}
+
+void Session::handleRoomJoinRequest(const std::string& room_name, uint64_t after_seq, bool keep_rooms) {
     auto room = room_manager_.getRoom(room_name);
     if (!room) {
         Message response(MessageType::ROOM_ERROR, "SERVER", "Room does not exist");
-        boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
+        send(response);
         return;
     }
     
-    // 이전 방에서 나가기
-    if (!current_room_.empty()) {
-        auto old_room = room_manager_.getRoom(current_room_);
-        if (old_room && user_) {
-            auto user_ptr = std::make_shared<User>(user_->getSocket(), user_->getName());
-            old_room->leave(user_ptr);
-        }
+    // 추가 입장이 아니면 이전 방들에서 나가기 (이미 입장한 방이면 나갔다 다시 들어가 놓친 메시지를 받음)
+    if (!keep_rooms) {
+        leaveAllRooms();
+    } else if (auto joined = findJoinedRoom(room_name)) {
+        leaveRoom(joined);
+    } else if (rooms_.size() >= config_.max_rooms_per_session) {
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Too many rooms joined", room_name);
+        send(response);
+        return;
     }
     
-    // User 객체 생성 또는 업데이트
-    if (!user_) {
-        user_ = std::make_shared<SessionUser>(socket_, username_);
+    // 코어 샤드를 쓰면 방을 맡은 샤드로 옮겨 가서 입장 (이 요청 뒤의 수신은 새 샤드에서 처리)
+    // 여러 방에 입장한 연결은 첫 방의 샤드에 머물고, 나머지 방에 보내는 채팅은 작업 큐로 넘김
+    if (core_shards_ && rooms_.empty()) {
+        size_t owner = core_shards_->ownerOf(room->getNameId());
+        if (static_cast<int>(owner) != shard_) {
+            migrate_to_ = static_cast<int>(owner);
+            after_migration_ = [this, room, room_name, after_seq]() { joinRoom(room, room_name, after_seq); };
+            return;
+        }
     }
-    
-    // 새 방에 입장
-    current_room_ = room_name;
-    auto user_ptr = std::make_shared<User>(user_->getSocket(), user_->getName());
-    room->join(user_ptr);
+    joinRoom(room, room_name, after_seq);
+}
+
+void Session::joinRoom(const std::shared_ptr<ChatRoom>& room, const std::string& room_name, uint64_t after_seq) {
+    // 새 방에 입장 (방금 정리된 방이면 실패)
+    if (!room->join(user_, after_seq)) {
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Room does not exist");
+        send(response);
+        return;
+    }
+    rooms_.push_back(room);
     
     Message response(MessageType::ROOM_JOIN, "SERVER", "Joined room: " + room_name, room_name);
-    boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
+    send(response);
     
-    add_log_message("User %s joined room: %s", username_.c_str(), room_name.c_str());
+    add_log_message("User %s joined room: %s", username().c_str(), room_name.c_str());
     
     auto room_list = room_manager_.getRoomList();
     size_t total_users = 0;
@@ -317,55 +775,475 @@ void Session::handleRoomJoinRequest(const std::string& room_name) {
     update_status_window(total_users, room_list);
 }
 
-void Session::handleRoomLeaveRequest() {
-    if (!current_room_.empty()) {
-        auto room = room_manager_.getRoom(current_room_);
-        if (room && user_) {
-            auto user_ptr = std::make_shared<User>(user_->getSocket(), user_->getName());
-            room->leave(user_ptr);
-        }
-        current_room_.clear();
-        
+void Session::handleRoomLeaveRequest(const std::string& room_name) {
+    if (rooms_.empty()) {
+        return;
+    }
+    
+    // 방 이름이 없으면 입장한 방 모두에서 나감
+    if (room_name.empty()) {
+        leaveAllRooms();
         Message response(MessageType::ROOM_LEAVE, "SERVER", "Left room");
-        boost::asio::write(socket_, boost::asio::buffer(response.serialize()));
-        
-        add_log_message("User %s left room", username_.c_str());
+        send(response);
+        add_log_message("User %s left room", username().c_str());
+    } else {
+        auto room = findJoinedRoom(room_name);
+        if (!room) {
+            Message response(MessageType::ROOM_ERROR, "SERVER", "Not in room: " + room_name, room_name);
+            send(response);
+            return;
+        }
+        leaveRoom(room);
+        Message response(MessageType::ROOM_LEAVE, "SERVER", "Left room: " + room_name, room_name);
+        send(response);
+        add_log_message("User %s left room: %s", username().c_str(), room_name.c_str());
+    }
+    
+    auto room_list = room_manager_.getRoomList();
+    size_t total_users = 0;
+    for (const auto& room_info : room_list) {
+        total_users += room_info.user_count;
+    }
+    update_status_window(total_users, room_list);
+}
+
+void Session::handleChatMessage(const Message& msg) {
+    // 입장할 때 저장해 둔 방을 사용 (메시지마다 채팅방 검색을 하지 않음)
+    if (rooms_.empty()) {
+        return;
+    }
+    
+    // 방 이름이 없으면 마지막으로 입장한 방, 쉼표로 나열하면 그 방들 모두에 보냄
+    std::vector<std::shared_ptr<ChatRoom>> targets;
+    if (msg.getRoomName().empty()) {
+        targets.push_back(rooms_.back());
+    } else {
+        const std::string& names = msg.getRoomName();
+        for (size_t begin = 0; begin <= names.size();) {
+            size_t end = std::min(names.find(',', begin), names.size());
+            std::string room_name = names.substr(begin, end - begin);
+            begin = end + 1;
+            
+            auto room = findJoinedRoom(room_name);
+            if (!room) {
+                Message response(MessageType::ROOM_ERROR, "SERVER", "Not in room: " + room_name, room_name);
+                send(response);
+                return;
+            }
+            if (std::find(targets.begin(), targets.end(), room) == targets.end()) {
+                targets.push_back(std::move(room));
+            }
+        }
+    }
+    
+    // 연결당 한도를 먼저 확인해 한 사용자가 방 전체 한도를 소진하지 못하게 함
+    // 한 방이라도 한도를 넘으면 아무 데도 보내지 않으므로 앞에서 소비한 토큰은 되돌림
+    if (!chat_bucket_.tryConsume(config_.rate_limits.session_chat)) {
+        sendRateLimitError();
+        return;
+    }
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (!targets[i]->tryAcquireChat(config_.rate_limits.room_chat)) {
+            for (size_t j = 0; j < i; ++j) {
+                targets[j]->releaseChat(config_.rate_limits.room_chat);
+            }
+            chat_bucket_.refund(config_.rate_limits.session_chat);
+            sendRateLimitError();
+            return;
+        }
+    }
+    
+    broadcastTo(targets, msg.getContent());
+}
+
+void Session::broadcastTo(const std::vector<std::shared_ptr<ChatRoom>>& targets, const std::string& content) {
+    // 여러 방에 함께 있는 사용자는 먼저 전달한 방에서 한 번만 받음 (대상 방들이 받은 사용자 표시를 함께 씀)
+    std::shared_ptr<ChatRoom::Recipients> recipients;
+    if (targets.size() > 1) {
+        recipients = std::make_shared<ChatRoom::Recipients>();
+    }
+    const std::string& sender = username();
+    auto isLocal = [this](const std::shared_ptr<ChatRoom>& room) {
+        return !core_shards_ || static_cast<int>(core_shards_->ownerOf(room->getNameId())) == shard_;
+    };
+    
+    // 방을 맡은 샤드가 아니면 그 샤드의 작업 큐로 넘김 (입장할 때 옮겨 오므로 드묾)
+    // 같은 샤드가 맡은 방들은 한 작업으로 묶고, 이 샤드의 방에는 모두 넘긴 뒤에만 보냄
+    std::vector<std::shared_ptr<ChatRoom>> undelivered;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (isLocal(targets[i])) {
+            continue;
+        }
+        size_t owner = core_shards_->ownerOf(targets[i]->getNameId());
+        bool grouped = false;
+        for (size_t j = 0; j < i && !grouped; ++j) {
+            grouped = (core_shards_->ownerOf(targets[j]->getNameId()) == owner);
+        }
+        if (grouped) {
+            continue;
+        }
+        std::vector<std::shared_ptr<ChatRoom>> rooms;
+        for (size_t j = i; j < targets.size(); ++j) {
+            if (core_shards_->ownerOf(targets[j]->getNameId()) == owner) {
+                rooms.push_back(targets[j]);
+            }
+        }
         
-        auto room_list = room_manager_.getRoomList();
-        size_t total_users = 0;
-        for (const auto& room_info : room_list) {
-            total_users += room_info.user_count;
+        // 한 샤드라도 넘기지 못하면 나머지 샤드에는 넘기지 않음
+        if (undelivered.empty()) {
+            CoreShards::Task task = [rooms, sender, content, recipients]() {
+                for (const auto& room : rooms) {
+                    room->broadcast(MessageType::CHAT_MSG, sender, content, recipients);
+                }
+            };
+            if (core_shards_->post(owner, std::move(task))) {
+                for (const auto& room : rooms) {
+                    room_manager_.relayChat(*room, sender, content);
+                }
+                continue;
+            }
+            metrics().core_queue_full.add();
+        }
+        undelivered.insert(undelivered.end(), rooms.begin(), rooms.end());
+    }
+    
+    // 큐가 가득 차 넘기지 못했으면 이 샤드의 방에도 보내지 않고, 보내지 못한 방들의 토큰을 되돌림
+    if (!undelivered.empty()) {
+        for (const auto& room : targets) {
+            if (isLocal(room)) {
+                undelivered.push_back(room);
+            }
+        }
+        std::string names;
+        for (const auto& room : undelivered) {
+            room->releaseChat(config_.rate_limits.room_chat);
+            names += (names.empty() ? "" : ",") + room->getName();
+        }
+        // 아무 방에도 보내지 못했으면 연결당 토큰도 되돌림
+        if (undelivered.size() == targets.size()) {
+            chat_bucket_.refund(config_.rate_limits.session_chat);
+        }
+        Message response(MessageType::ROOM_ERROR, "SERVER", "Server busy, please retry", names);
+        send(response);
+        return;
+    }
+    
+    for (const auto& room : targets) {
+        if (isLocal(room)) {
+            room->broadcast(MessageType::CHAT_MSG, sender, content, recipients);
+            room_manager_.relayChat(*room, sender, content);
         }
-        update_status_window(total_users, room_list);
     }
 }
 
+void Session::handleDirectMessage(const Message& msg) {
+    if (!chat_bucket_.tryConsume(config_.rate_limits.session_chat)) {
+        sendRateLimitError();
+        return;
+    }
+    
+    // 이름 -> 세션 색인으로 받는 사람을 바로 찾음 (채팅방을 거치지 않음)
+    NameId recipient_id = names().find(msg.getRoomName());
+    auto recipient = (recipient_id != EMPTY_NAME_ID) ? user_registry_.find(recipient_id) : nullptr;
+    if (!recipient) {
+        Message response(MessageType::ROOM_ERROR, "SERVER", "User not found: " + msg.getRoomName());
+        send(response);
+        return;
+    }
+    
+    auto frame = std::make_shared<const std::string>(
+        Message(MessageType::DIRECT_MSG, username(), msg.getContent(), msg.getRoomName()).serialize());
+    recipient->deliver(frame);
+    // 보낸 사람 화면에도 표시되도록 함께 전송
+    if (recipient.get() != this) {
+        deliver(frame);
+    }
+    metrics().direct_messages.add();
+}
+
+void Session::sendRateLimitError() {
+    metrics().rate_limited.add();
+    Message response(MessageType::ROOM_ERROR, "SERVER", "Rate limit exceeded, please slow down");
+    send(response);
+}
+
 // SocketManager 클래스 구현
-SocketManager::SocketManager(boost::asio::io_context& io_context, const tcp::endpoint& endpoint)
-    : acceptor_(io_context, endpoint) {
+SocketManager::Listener::Listener(boost::asio::io_context& io_context, const tcp::endpoint& endpoint,
+                                  const ServerConfig& config, bool reuse_port)
+    : acceptor(io_context), timer_wheel(std::make_shared<TimerWheel>(WHEEL_TICK)), wheel_timer(io_context) {
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(tcp::acceptor::reuse_address(true));
+    if (reuse_port) {
+        // 같은 포트의 수락 소켓들 사이에서 커널이 새 연결을 나눠 줌
+        acceptor.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    }
+    acceptor.bind(endpoint);
+    acceptor.listen(config.listen_backlog);
+}
+
+SocketManager::SocketManager(boost::asio::io_context& io_context, const tcp::endpoint& endpoint,
+                             ServerConfig& config)
+    : config_(config), reap_timer_(io_context), room_update_timer_(io_context), drain_timer_(io_context),
+      user_registry_(config.resume_window) {
+    
+    size_t acceptor_count = std::max<size_t>(1, config_.acceptor_threads);
+    bool reuse_port = acceptor_count > 1;
+    listeners_.push_back(std::make_unique<Listener>(io_context, endpoint, config_, reuse_port));
+    for (size_t i = 1; i < acceptor_count; ++i) {
+        worker_contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+        listeners_.push_back(std::make_unique<Listener>(*worker_contexts_.back(), endpoint, config_, reuse_port));
+    }
+    
+    // 코어 샤드를 쓰면 수락 루프는 연결만 받아 샤드들에 나눠 주고, 세션과 방은 샤드 스레드에서 처리
+    if (config_.core_shards > 0) {
+        core_shards_ = std::make_unique<CoreShards>(config_.core_shards, WHEEL_TICK);
+        CoreShards* shards = core_shards_.get();
+        room_manager_.setRoomExecutor([shards](NameId room_id, std::function<void()> task) {
+            if (!shards->post(shards->ownerOf(room_id), std::move(task))) {
+                // 큐가 가득 차면 여기서 바로 보냄 (방 상태는 방의 락이 보호)
+                task();
+            }
+        });
+    }
+    
+    // 큰 방의 전송은 수락 루프(코어 샤드를 쓰면 샤드)의 스레드들에 나눠 맡김
+    // io_context에 바로 post하면 자기 스레드에서 넣은 작업이 다른 스레드가 넣은 작업보다 늦게 실행될 수 있어
+    // 스트랜드를 거쳐 넣은 순서대로 실행되게 함
+    FanoutPool fanout;
+    fanout.min_room_size = config_.fanout_min_room;
+    auto add_fanout_executor = [&fanout](auto executor) {
+        auto strand = boost::asio::make_strand(executor);
+        fanout.executors.push_back([strand](std::function<void()> task) {
+            boost::asio::post(strand, std::move(task));
+        });
+    };
+    if (core_shards_) {
+        for (size_t i = 0; i < core_shards_->size(); ++i) {
+            add_fanout_executor(core_shards_->context(i).get_executor());
+        }
+    } else {
+        for (auto& listener : listeners_) {
+            add_fanout_executor(listener->acceptor.get_executor());
+        }
+    }
+    room_manager_.setFanoutPool(std::move(fanout));
+    
+    // 클러스터 - 다른 노드와 방을 공유
+    if (!config_.relay_address.empty()) {
+        size_t colon = config_.relay_address.rfind(':');
+        std::string host = (colon == std::string::npos) ? config_.relay_address : config_.relay_address.substr(0, colon);
+        std::string port = (colon == std::string::npos) ? "9090" : config_.relay_address.substr(colon + 1);
+        std::string node_name = config_.node_name;
+        if (node_name.empty()) {
+            char hostname[256] = {};
+            ::gethostname(hostname, sizeof(hostname) - 1);
+            node_name = std::string(hostname) + ":" + std::to_string(endpoint.port());
+        }
+        relay_link_ = std::make_unique<RelayLink>(io_context, room_manager_, host, port, node_name);
+        room_manager_.setRelay(relay_link_.get());
+    }
     
     setlocale(LC_ALL, "");
     
     init_server_ui();
-    add_log_message("Server started on port %d", endpoint.port());
+    add_log_message("Server started on port %d (%zu acceptors)", endpoint.port(), acceptor_count);
+    if (core_shards_) {
+        add_log_message("Core shards: %zu", core_shards_->size());
+    }
     update_status_window(0, {});
     
-    startAccept();
+    for (auto& listener : listeners_) {
+        scheduleWheelTick(*listener);
+        startAccept(*listener);
+    }
+    if (!config_.unix_socket_path.empty()) {
+        // 이전 실행에서 남은 소켓 파일은 지우고 다시 만듦
+        ::unlink(config_.unix_socket_path.c_str());
+        unix_acceptor_ = std::make_unique<boost::asio::local::stream_protocol::acceptor>(
+            io_context, boost::asio::local::stream_protocol::endpoint(config_.unix_socket_path));
+        add_log_message("Listening on unix socket %s", config_.unix_socket_path.c_str());
+        startUnixAccept();
+    }
+    if (relay_link_) {
+        relay_link_->start();
+    }
+    scheduleRoomUpdatePublish();
+    if (config_.room_idle_timeout.count() > 0) {
+        scheduleRoomReap();
+    }
+    
+    // 첫 번째 수락 루프는 호출한 쪽이 io_context를 실행할 때 함께 돌아감
+    for (auto& context : worker_contexts_) {
+        worker_threads_.emplace_back([&context]() { context->run(); });
+    }
 }
 
 SocketManager::~SocketManager() {
+    for (auto& context : worker_contexts_) {
+        context->stop();
+    }
+    for (auto& thread : worker_threads_) {
+        thread.join();
+    }
+    if (core_shards_) {
+        core_shards_->stop();
+        room_manager_.setRoomExecutor(nullptr);
+    }
+    room_manager_.setRelay(nullptr);
+    // 전송용 스트랜드는 자기 io_context보다 먼저 정리되어야 함
+    room_manager_.setFanoutPool(FanoutPool());
+    if (unix_acceptor_) {
+        ::unlink(config_.unix_socket_path.c_str());
+    }
     cleanup_server_ui();
 }
 
-void SocketManager::startAccept() {
-    acceptor_.async_accept(
-        [this](boost::system::error_code ec, tcp::socket socket) {
+void SocketManager::startAccept(Listener& listener) {
+    listener.acceptor.async_accept(
+        [this, &listener](boost::system::error_code ec, tcp::socket socket) {
+            // 종료 중 수락 소켓이 닫힘
+            if (!listener.acceptor.is_open()) {
+                return;
+            }
+            if (!ec) {
+                // 채팅 메시지는 작고 지연에 민감하므로 Nagle 알고리즘을 끔
+                boost::system::error_code ignored;
+                socket.set_option(tcp::no_delay(true), ignored);
+                auto remote = socket.remote_endpoint(ignored);
+                std::string address = ignored ? "unknown" : remote.address().to_string();
+                startSession(Session::Socket(std::move(socket)), std::move(address), listener);
+            }
+            
+            startAccept(listener);
+        });
+}
+
+void SocketManager::startSession(Session::Socket socket, std::string address, Listener& listener) {
+    if (!core_shards_) {
+        std::make_shared<Session>(std::move(socket), std::move(address), room_manager_, user_registry_, config_,
+                                  listener.timer_wheel)->start();
+        return;
+    }
+    
+    // 방에 입장하기 전까지 있을 샤드는 돌아가며 정함
+    size_t shard = next_shard_.fetch_add(1, std::memory_order_relaxed) % core_shards_->size();
+    auto session = std::make_shared<Session>(moveSocket(socket, core_shards_->context(shard)), std::move(address),
+                                             room_manager_, user_registry_, config_, core_shards_->timerWheel(shard),
+                                             core_shards_.get(), static_cast<int>(shard));
+    boost::asio::post(core_shards_->context(shard), [session]() { session->start(); });
+}
+
+void SocketManager::startUnixAccept() {
+    unix_acceptor_->async_accept(
+        [this](boost::system::error_code ec, boost::asio::local::stream_protocol::socket socket) {
+            if (!unix_acceptor_->is_open()) {
+                return;
+            }
             if (!ec) {
-                std::make_shared<Session>(std::move(socket), room_manager_)->start();
+                startSession(Session::Socket(std::move(socket)), "unix:" + config_.unix_socket_path,
+                             *listeners_.front());
             }
             
-            startAccept();
+            startUnixAccept();
         });
 }
 
-} // namespace wagle
\ No newline at end of file
+void SocketManager::shutdown(std::function<void()> on_drained) {
+    add_log_message("Shutting down, draining %zu sessions", user_registry_.size());
+    
+    // 새 연결은 더 받지 않음 (수락 소켓은 각자의 스레드에서 닫음)
+    for (auto& listener : listeners_) {
+        Listener* l = listener.get();
+        boost::asio::post(l->acceptor.get_executor(), [l]() {
+            boost::system::error_code ignored;
+            l->acceptor.close(ignored);
+        });
+    }
+    if (unix_acceptor_) {
+        boost::system::error_code ignored;
+        unix_acceptor_->close(ignored);
+    }
+    reap_timer_.cancel();
+    if (relay_link_) {
+        relay_link_->stop();
+    }
+    
+    // 접속 중인 세션에 종료를 알리고 남은 메시지를 보낸 뒤 닫게 함
+    for (const auto& session : user_registry_.snapshot()) {
+        session->drain();
+    }
+    
+    // 재시작 후에도 대화 기록을 볼 수 있도록 남김
+    if (!config_.room_log_dir.empty()) {
+        room_manager_.saveAllHistory(config_.room_log_dir);
+    }
+    
+    on_drained_ = std::move(on_drained);
+    drain_deadline_ = std::chrono::steady_clock::now() + config_.shutdown_timeout;
+    waitForDrain();
+}
+
+void SocketManager::waitForDrain() {
+    if (user_registry_.size() == 0 || std::chrono::steady_clock::now() >= drain_deadline_) {
+        if (user_registry_.size() > 0) {
+            add_log_message("Shutdown timeout, closing %zu sessions", user_registry_.size());
+        }
+        on_drained_();
+        return;
+    }
+    
+    drain_timer_.expires_after(std::chrono::milliseconds(100));
+    drain_timer_.async_wait([this](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+        waitForDrain();
+    });
+}
+
+void SocketManager::scheduleWheelTick(Listener& listener) {
+    listener.wheel_timer.expires_after(listener.timer_wheel->getTick());
+    listener.wheel_timer.async_wait([this, &listener](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+        listener.timer_wheel->advance(TimerWheel::clock::now());
+        scheduleWheelTick(listener);
+    });
+}
+
+void SocketManager::scheduleRoomUpdatePublish() {
+    room_update_timer_.expires_after(ROOM_UPDATE_INTERVAL);
+    room_update_timer_.async_wait([this](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+        room_manager_.publishRoomUpdates();
+        scheduleRoomUpdatePublish();
+    });
+}
+
+void SocketManager::scheduleRoomReap() {
+    // 정리 시점이 제한 시간을 크게 넘기지 않도록 제한 시간의 1/4 간격으로 확인
+    auto interval = std::max(std::chrono::seconds(1), config_.room_idle_timeout / 4);
+    reap_timer_.expires_after(interval);
+    reap_timer_.async_wait([this](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+        size_t reaped = room_manager_.reapIdleRooms(config_.room_idle_timeout, config_.room_log_dir);
+        if (reaped > 0) {
+            add_log_message("Reaped %zu idle rooms", reaped);
+            
+            auto room_list = room_manager_.getRoomList();
+            size_t total_users = 0;
+            for (const auto& room_info : room_list) {
+                total_users += room_info.user_count;
+            }
+            update_status_window(total_users, room_list);
+        }
+        scheduleRoomReap();
+    });
+}
+
+} // namespace wagle
@@ -0,0 +1,146 @@
+#include "socket/user_registry.h"
+#include <cstdio>
+#include <random>
+
+namespace wagle {
+
+namespace {
+
+// 같은 세션 객체를 가리키는지 (제어 블록 기준이라 해제된 세션의 주소가 재사용되어도 구분됨)
+bool sameSession(const std::weak_ptr<Session>& a, const std::weak_ptr<Session>& b) {
+    return !a.owner_before(b) && !b.owner_before(a);
+}
+
+} // namespace
+
+bool UserRegistry::claim(NameId name_id, const std::shared_ptr<Session>& session) {
+    Shard& shard = shardFor(name_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    // 연결이 끊긴 세션의 재개 토큰이 유효한 동안에는 이름을 예약해 둠
+    auto token = shard.tokens.find(name_id);
+    if (token != shard.tokens.end()) {
+        auto expires = token->second.expires;
+        if (expires != clock::time_point::max() && expires > clock::now()) {
+            return false;
+        }
+    }
+    
+    auto result = shard.sessions.emplace(name_id, session);
+    if (!result.second) {
+        // 정리되지 않고 남은 종료된 세션의 이름은 넘겨받음
+        if (!result.first->second.expired()) {
+            return false;
+        }
+        result.first->second = session;
+    } else {
+        count_++;
+    }
+    // 만료되었거나 해제 없이 종료된 세션의 토큰은 새 소유자에게 넘어가지 않도록 폐기
+    if (token != shard.tokens.end()) {
+        shard.tokens.erase(token);
+    }
+    return true;
+}
+
+void UserRegistry::release(NameId name_id, const Session* session) {
+    Shard& shard = shardFor(name_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.sessions.find(name_id);
+    if (it == shard.sessions.end()) {
+        return;
+    }
+    // 소멸 중인 세션은 weak_ptr이 이미 만료되었으므로 만료된 항목도 해제
+    auto owner = it->second.lock();
+    if (owner && owner.get() != session) {
+        return;
+    }
+    shard.sessions.erase(it);
+    count_--;
+    
+    // 재개 토큰은 일정 시간 더 유지하고, 그 사이 만료된 같은 샤드의 토큰은 정리
+    auto now = clock::now();
+    auto token = shard.tokens.find(name_id);
+    if (token != shard.tokens.end()) {
+        token->second.expires = now + resume_window_;
+    }
+    for (auto t = shard.tokens.begin(); t != shard.tokens.end();) {
+        if (t->second.expires <= now) {
+            t = shard.tokens.erase(t);
+        } else {
+            ++t;
+        }
+    }
+}
+
+std::string UserRegistry::issueResumeToken(const NameRef& name, const std::shared_ptr<Session>& session) {
+    if (resume_window_.count() == 0) {
+        return "";
+    }
+    
+    // 추측할 수 없도록 OS 난수로 128비트 생성
+    static thread_local std::random_device entropy;
+    char token[33];
+    std::snprintf(token, sizeof(token), "%08x%08x%08x%08x", entropy(), entropy(), entropy(), entropy());
+    
+    Shard& shard = shardFor(name.id());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.tokens[name.id()] = ResumeToken{token, clock::time_point::max(), name, session};
+    return token;
+}
+
+bool UserRegistry::resume(NameId name_id, const std::string& token, const std::shared_ptr<Session>& session,
+                          std::shared_ptr<Session>& previous) {
+    Shard& shard = shardFor(name_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto entry = shard.tokens.find(name_id);
+    if (entry == shard.tokens.end() || entry->second.token != token || entry->second.expires <= clock::now()) {
+        return false;
+    }
+    
+    // 이름을 가진 살아 있는 세션이 토큰을 받은 세션이 아니면 다른 사용자의 세션이므로 넘겨받지 않음
+    auto current = shard.sessions.find(name_id);
+    if (current != shard.sessions.end() && !current->second.expired() &&
+        !sameSession(current->second, entry->second.owner)) {
+        return false;
+    }
+    shard.tokens.erase(entry);
+    
+    auto result = shard.sessions.emplace(name_id, session);
+    if (!result.second) {
+        previous = result.first->second.lock();
+        result.first->second = session;
+    } else {
+        count_++;
+    }
+    return true;
+}
+
+std::shared_ptr<Session> UserRegistry::find(NameId name_id) const {
+    const Shard& shard = shardFor(name_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.sessions.find(name_id);
+    if (it == shard.sessions.end()) {
+        return nullptr;
+    }
+    return it->second.lock();
+}
+
+std::vector<std::shared_ptr<Session>> UserRegistry::snapshot() const {
+    std::vector<std::shared_ptr<Session>> sessions;
+    sessions.reserve(size());
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& entry : shard.sessions) {
+            if (auto session = entry.second.lock()) {
+                sessions.push_back(std::move(session));
+            }
+        }
+    }
+    return sessions;
+}
+
+} // namespace wagle